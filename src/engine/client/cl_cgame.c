@@ -706,6 +706,44 @@ intptr_t CL_CgameSystemCalls( intptr_t *args ) {
 	return 0;
 }
 
+/*
+====================
+CL_CgameProfiledSystemCalls
+
+Used instead of CL_CgameSystemCalls for a profiled timedemo, charges
+the traps that do real work to the subsystem they belong to
+====================
+*/
+static intptr_t CL_CgameProfiledSystemCalls( intptr_t *args ) {
+	int			*counter;
+	int			start;
+	intptr_t	ret;
+
+	switch( args[0] ) {
+	case CG_CM_POINTCONTENTS:
+	case CG_CM_TRANSFORMEDPOINTCONTENTS:
+	case CG_CM_BOXTRACE:
+	case CG_CM_CAPSULETRACE:
+	case CG_CM_TRANSFORMEDBOXTRACE:
+	case CG_CM_TRANSFORMEDCAPSULETRACE:
+		counter = &clc.timeDemoProfile.collision;
+		break;
+	case CG_CM_MARKFRAGMENTS:
+		counter = &clc.timeDemoProfile.marks;
+		break;
+	case CG_R_RENDERSCENE:
+		counter = &clc.timeDemoProfile.scene;
+		break;
+	default:
+		return CL_CgameSystemCalls( args );
+	}
+
+	start = Sys_Microseconds();
+	ret = CL_CgameSystemCalls( args );
+	*counter += Sys_Microseconds() - start;
+	return ret;
+}
+
 
 /*
 ====================
@@ -738,7 +776,7 @@ void CL_InitCGame( void ) {
 	else {
 		interpret = (vmInterpret_t) (int) Cvar_VariableValue( "vm_cgame" );
 	}
-	cgvm = VM_Create( "cgame", CL_CgameSystemCalls, interpret );
+	cgvm = VM_Create( "cgame", CL_TimeDemoProfiling() ? CL_CgameProfiledSystemCalls : CL_CgameSystemCalls, interpret );
 	if ( !cgvm ) {
 		Com_Error( ERR_DROP, "VM_Create on cgame failed" );
 	}
@@ -794,7 +832,15 @@ CL_CGameRendering
 =====================
 */
 void CL_CGameRendering( stereoFrame_t stereo ) {
-	VM_Call( cgvm, CG_DRAW_ACTIVE_FRAME, cl.serverTime, stereo, clc.demoplaying );
+	int		start;
+
+	if ( CL_TimeDemoProfiling() ) {
+		start = Sys_Microseconds();
+		VM_Call( cgvm, CG_DRAW_ACTIVE_FRAME, cl.serverTime, stereo, clc.demoplaying );
+		clc.timeDemoProfile.cgame += Sys_Microseconds() - start;
+	} else {
+		VM_Call( cgvm, CG_DRAW_ACTIVE_FRAME, cl.serverTime, stereo, clc.demoplaying );
+	}
 	VM_Debug( 0 );
 }
 
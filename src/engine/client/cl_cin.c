@@ -33,6 +33,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "client.h"
 #include "snd_local.h"
+#include <emmintrin.h> // SSE2 is always available on x64
 
 #define MAXSIZE				8
 #define MINSIZE				4
@@ -332,28 +333,17 @@ long RllDecodeStereoToMono(unsigned char *from,short *to,unsigned int size,char
 
 static void move8_32( byte *src, byte *dst, int spl )
 {
-	double *dsrc, *ddst;
-	int dspl;
-
-	dsrc = (double *)src;
-	ddst = (double *)dst;
-	dspl = spl>>3;
-
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1]; ddst[2] = dsrc[2]; ddst[3] = dsrc[3];
-	dsrc += dspl; ddst += dspl;
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1]; ddst[2] = dsrc[2]; ddst[3] = dsrc[3];
-	dsrc += dspl; ddst += dspl;
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1]; ddst[2] = dsrc[2]; ddst[3] = dsrc[3];
-	dsrc += dspl; ddst += dspl;
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1]; ddst[2] = dsrc[2]; ddst[3] = dsrc[3];
-	dsrc += dspl; ddst += dspl;
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1]; ddst[2] = dsrc[2]; ddst[3] = dsrc[3];
-	dsrc += dspl; ddst += dspl;
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1]; ddst[2] = dsrc[2]; ddst[3] = dsrc[3];
-	dsrc += dspl; ddst += dspl;
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1]; ddst[2] = dsrc[2]; ddst[3] = dsrc[3];
-	dsrc += dspl; ddst += dspl;
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1]; ddst[2] = dsrc[2]; ddst[3] = dsrc[3];
+	__m128i a, b;
+	int i;
+
+	// rows are 8 pixels, neither side is aligned
+	for ( i = 0; i < 8; i++ ) {
+		a = _mm_loadu_si128( (const __m128i *)src );
+		b = _mm_loadu_si128( (const __m128i *)(src + 16) );
+		_mm_storeu_si128( (__m128i *)dst, a );
+		_mm_storeu_si128( (__m128i *)(dst + 16), b );
+		src += spl; dst += spl;
+	}
 }
 
 /******************************************************************************
@@ -366,20 +356,16 @@ static void move8_32( byte *src, byte *dst, int spl )
 
 static void move4_32( byte *src, byte *dst, int spl  )
 {
-	double *dsrc, *ddst;
-	int dspl;
-
-	dsrc = (double *)src;
-	ddst = (double *)dst;
-	dspl = spl>>3;
-
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1];
-	dsrc += dspl; ddst += dspl;
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1];
-	dsrc += dspl; ddst += dspl;
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1];
-	dsrc += dspl; ddst += dspl;
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1];
+	__m128i a0, a1, a2, a3;
+
+	a0 = _mm_loadu_si128( (const __m128i *)src );
+	a1 = _mm_loadu_si128( (const __m128i *)(src + spl) );
+	a2 = _mm_loadu_si128( (const __m128i *)(src + spl*2) );
+	a3 = _mm_loadu_si128( (const __m128i *)(src + spl*3) );
+	_mm_storeu_si128( (__m128i *)dst, a0 );
+	_mm_storeu_si128( (__m128i *)(dst + spl), a1 );
+	_mm_storeu_si128( (__m128i *)(dst + spl*2), a2 );
+	_mm_storeu_si128( (__m128i *)(dst + spl*3), a3 );
 }
 
 /******************************************************************************
@@ -392,28 +378,17 @@ static void move4_32( byte *src, byte *dst, int spl  )
 
 static void blit8_32( byte *src, byte *dst, int spl  )
 {
-	double *dsrc, *ddst;
-	int dspl;
-
-	dsrc = (double *)src;
-	ddst = (double *)dst;
-	dspl = spl>>3;
-
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1]; ddst[2] = dsrc[2]; ddst[3] = dsrc[3];
-	dsrc += 4; ddst += dspl;
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1]; ddst[2] = dsrc[2]; ddst[3] = dsrc[3];
-	dsrc += 4; ddst += dspl;
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1]; ddst[2] = dsrc[2]; ddst[3] = dsrc[3];
-	dsrc += 4; ddst += dspl;
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1]; ddst[2] = dsrc[2]; ddst[3] = dsrc[3];
-	dsrc += 4; ddst += dspl;
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1]; ddst[2] = dsrc[2]; ddst[3] = dsrc[3];
-	dsrc += 4; ddst += dspl;
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1]; ddst[2] = dsrc[2]; ddst[3] = dsrc[3];
-	dsrc += 4; ddst += dspl;
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1]; ddst[2] = dsrc[2]; ddst[3] = dsrc[3];
-	dsrc += 4; ddst += dspl;
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1]; ddst[2] = dsrc[2]; ddst[3] = dsrc[3];
+	__m128i a, b;
+	int i;
+
+	// the codebook entry is 8 packed rows of 32 bytes
+	for ( i = 0; i < 8; i++ ) {
+		a = _mm_loadu_si128( (const __m128i *)src );
+		b = _mm_loadu_si128( (const __m128i *)(src + 16) );
+		_mm_storeu_si128( (__m128i *)dst, a );
+		_mm_storeu_si128( (__m128i *)(dst + 16), b );
+		src += 32; dst += spl;
+	}
 }
 
 /******************************************************************************
@@ -423,23 +398,18 @@ static void blit8_32( byte *src, byte *dst, int spl  )
 * Description:	
 *
 ******************************************************************************/
-#define movs double
 static void blit4_32( byte *src, byte *dst, int spl  )
 {
-	movs *dsrc, *ddst;
-	int dspl;
-
-	dsrc = (movs *)src;
-	ddst = (movs *)dst;
-	dspl = spl>>3;
-
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1];
-	dsrc += 2; ddst += dspl;
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1];
-	dsrc += 2; ddst += dspl;
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1];
-	dsrc += 2; ddst += dspl;
-	ddst[0] = dsrc[0]; ddst[1] = dsrc[1];
+	__m128i a0, a1, a2, a3;
+
+	a0 = _mm_loadu_si128( (const __m128i *)src );
+	a1 = _mm_loadu_si128( (const __m128i *)(src + 16) );
+	a2 = _mm_loadu_si128( (const __m128i *)(src + 32) );
+	a3 = _mm_loadu_si128( (const __m128i *)(src + 48) );
+	_mm_storeu_si128( (__m128i *)dst, a0 );
+	_mm_storeu_si128( (__m128i *)(dst + spl), a1 );
+	_mm_storeu_si128( (__m128i *)(dst + spl*2), a2 );
+	_mm_storeu_si128( (__m128i *)(dst + spl*3), a3 );
 }
 
 /******************************************************************************
@@ -676,6 +646,39 @@ static unsigned int yuv_to_rgb24( long y, long u, long v )
 }
 #endif
 
+/******************************************************************************
+*
+* Function:		yuv_to_rgb24_4
+*
+* Description:	four pixels sharing one chroma pair, same result as
+*				yuv_to_rgb24. Every sum fits in 16 bits, and the
+*				unsigned saturating pack does the clamping.
+*
+******************************************************************************/
+
+static void yuv_to_rgb24_4( long y0, long y1, long y2, long y3, long u, long v, unsigned int *out )
+{
+	__m128i	chroma, lo, hi;
+	short	r, g, b;
+	short	yy0, yy1, yy2, yy3;
+
+	r = (short)ROQ_VR_tab[v];
+	g = (short)(ROQ_UG_tab[u] + ROQ_VG_tab[v]);
+	b = (short)ROQ_UB_tab[u];
+	chroma = _mm_setr_epi16( r, g, b, 255<<6, r, g, b, 255<<6 );
+
+	yy0 = (short)ROQ_YY_tab[y0];
+	yy1 = (short)ROQ_YY_tab[y1];
+	yy2 = (short)ROQ_YY_tab[y2];
+	yy3 = (short)ROQ_YY_tab[y3];
+	lo = _mm_setr_epi16( yy0, yy0, yy0, 0, yy1, yy1, yy1, 0 );
+	hi = _mm_setr_epi16( yy2, yy2, yy2, 0, yy3, yy3, yy3, 0 );
+
+	lo = _mm_srai_epi16( _mm_add_epi16( lo, chroma ), 6 );
+	hi = _mm_srai_epi16( _mm_add_epi16( hi, chroma ), 6 );
+	_mm_storeu_si128( (__m128i *)out, _mm_packus_epi16( lo, hi ) );
+}
+
 /******************************************************************************
 *
 * Function:		
@@ -741,10 +744,8 @@ static void decodeCodeBook( byte *input, unsigned short roq_flags )
 					y3 = (long)*input++;
 					cr = (long)*input++;
 					cb = (long)*input++;
-					*ibptr++ = yuv_to_rgb24( y0, cr, cb );
-					*ibptr++ = yuv_to_rgb24( y1, cr, cb );
-					*ibptr++ = yuv_to_rgb24( y2, cr, cb );
-					*ibptr++ = yuv_to_rgb24( y3, cr, cb );
+					yuv_to_rgb24_4( y0, y1, y2, y3, cr, cb, ibptr );
+					ibptr += 4;
 				}
 
 				icptr = (unsigned int *)vq4;
@@ -817,14 +818,9 @@ static void decodeCodeBook( byte *input, unsigned short roq_flags )
 					y3 = (long)*input++;
 					cr = (long)*input++;
 					cb = (long)*input++;
-					*ibptr++ = yuv_to_rgb24( y0, cr, cb );
-					*ibptr++ = yuv_to_rgb24( y1, cr, cb );
-					*ibptr++ = yuv_to_rgb24( ((y0*3)+y2)/4, cr, cb );
-					*ibptr++ = yuv_to_rgb24( ((y1*3)+y3)/4, cr, cb );
-					*ibptr++ = yuv_to_rgb24( (y0+(y2*3))/4, cr, cb );
-					*ibptr++ = yuv_to_rgb24( (y1+(y3*3))/4, cr, cb );
-					*ibptr++ = yuv_to_rgb24( y2, cr, cb );
-					*ibptr++ = yuv_to_rgb24( y3, cr, cb );
+					yuv_to_rgb24_4( y0, y1, ((y0*3)+y2)/4, ((y1*3)+y3)/4, cr, cb, ibptr );
+					yuv_to_rgb24_4( (y0+(y2*3))/4, (y1+(y3*3))/4, y2, y3, cr, cb, ibptr + 4 );
+					ibptr += 8;
 				}
 
 				icptr = (unsigned int *)vq4;
@@ -1676,6 +1672,66 @@ void CL_PlayCinematic_f(void) {
 }
 
 
+/*
+==================
+CL_CinematicBench_f
+
+Decodes a RoQ as fast as possible without drawing it
+==================
+*/
+void CL_CinematicBench_f( void ) {
+	int		handle;
+	int		start, msec;
+	int		frames;
+	int		i;
+
+	if ( Cmd_Argc() != 2 ) {
+		Com_Printf( "usage: cinbench <file.roq>\n" );
+		return;
+	}
+
+	// every handle decodes through the one cin state, and a file that is
+	// already open would be handed back instead of started again
+	for ( i = 0 ; i < MAX_VIDEO_HANDLES ; i++ ) {
+		if ( cinTable[i].fileName[0] ) {
+			Com_Printf( "can't run cinbench while a cinematic is playing\n" );
+			return;
+		}
+	}
+
+	handle = CIN_PlayCinematic( Cmd_Argv( 1 ), 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, CIN_silent );
+	if ( handle < 0 ) {
+		Com_Printf( "couldn't open %s\n", Cmd_Argv( 1 ) );
+		return;
+	}
+
+	start = Sys_Milliseconds();
+	while ( cinTable[handle].status == FMV_PLAY ) {
+		RoQInterrupt();
+	}
+	msec = Sys_Milliseconds() - start;
+
+	frames = cinTable[handle].numQuads;
+	if ( frames < 0 ) {
+		frames = 0;
+	}
+	Com_Printf( "%i frames in %i msec, %.1f fps\n", frames, msec, msec ? frames * 1000.0f / msec : 0.0f );
+
+	// CIN_StopCinematic ignores a handle at FMV_EOF, and RoQShutdown
+	// ignores one that never decoded a frame
+	currentHandle = handle;
+	if ( cinTable[handle].buf ) {
+		RoQShutdown();
+	} else {
+		Sys_EndStreamedFile( cinTable[handle].iFile );
+		FS_FCloseFile( cinTable[handle].iFile );
+		cinTable[handle].iFile = 0;
+		cinTable[handle].status = FMV_IDLE;
+		cinTable[handle].fileName[0] = 0;
+		currentHandle = -1;
+	}
+}
+
 void SCR_DrawCinematic (void) {
 	if (CL_handle >= 0 && CL_handle < MAX_VIDEO_HANDLES) {
 		CIN_DrawCinematic(CL_handle);
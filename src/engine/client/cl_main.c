@@ -43,6 +43,7 @@ cvar_t	*cl_freezeDemo;
 cvar_t	*cl_shownet;
 cvar_t	*cl_showSend;
 cvar_t	*cl_timedemo;
+cvar_t	*cl_timedemoLog;
 cvar_t	*cl_avidemo;
 cvar_t	*cl_forceavidemo;
 
@@ -388,6 +389,63 @@ CLIENT SIDE DEMO PLAYBACK
 =======================================================================
 */
 
+/*
+=================
+CL_TimeDemoProfiling
+
+A timedemo with cl_timedemoLog set also times the client subsystems.
+With the null render API nothing needs a GPU, so it runs as a regression
+benchmark on any machine:
+
+  +set r_renderAPI 3 +set timedemo 1 +set cl_timedemoLog bench.json +demo four
+=================
+*/
+qboolean CL_TimeDemoProfiling( void ) {
+	return ( cl_timedemo && cl_timedemo->integer && cl_timedemoLog && cl_timedemoLog->string[0] ) ? qtrue : qfalse;
+}
+
+/*
+=================
+CL_WriteTimeDemoLog
+
+Writes the timedemo results as JSON
+=================
+*/
+static void CL_WriteTimeDemoLog( int msec ) {
+	fileHandle_t		f;
+	timeDemoProfile_t	*p;
+
+	f = FS_FOpenFileWrite( cl_timedemoLog->string );
+	if ( !f ) {
+		Com_Printf( "ERROR: couldn't open %s\n", cl_timedemoLog->string );
+		return;
+	}
+
+	p = &clc.timeDemoProfile;
+	FS_Printf( f, "{\n" );
+	FS_Printf( f, "\t\"demo\": \"%s\",\n", clc.demoName );
+	FS_Printf( f, "\t\"renderAPI\": \"%s\",\n", Cvar_VariableString( "r_activeRenderAPI" ) );
+	FS_Printf( f, "\t\"skipBackEnd\": %i,\n", Cvar_VariableIntegerValue( "r_skipBackEnd" ) );
+	FS_Printf( f, "\t\"frames\": %i,\n", clc.timeDemoFrames );
+	FS_Printf( f, "\t\"msec\": %i,\n", msec );
+	FS_Printf( f, "\t\"fps\": %.1f,\n", msec > 0 ? clc.timeDemoFrames * 1000.0 / msec : 0.0 );
+	FS_Printf( f, "\t\"frameUsec\": { \"min\": %i, \"max\": %i, \"avg\": %i },\n",
+		p->frameMin, p->frameMax, p->frameCount ? p->frameTotal / p->frameCount : 0 );
+	FS_Printf( f, "\t\"usec\": {\n" );
+	FS_Printf( f, "\t\t\"parse\": %i,\n", p->parse );
+	FS_Printf( f, "\t\t\"snapshots\": %i,\n", p->snapshots );
+	FS_Printf( f, "\t\t\"cgame\": %i,\n", p->cgame );
+	FS_Printf( f, "\t\t\"collision\": %i,\n", p->collision );
+	FS_Printf( f, "\t\t\"marks\": %i,\n", p->marks );
+	FS_Printf( f, "\t\t\"scene\": %i,\n", p->scene );
+	FS_Printf( f, "\t\t\"endFrame\": %i\n", p->endFrame );
+	FS_Printf( f, "\t}\n" );
+	FS_Printf( f, "}\n" );
+	FS_FCloseFile( f );
+
+	Com_Printf( "Wrote %s\n", cl_timedemoLog->string );
+}
+
 /*
 =================
 CL_DemoCompleted
@@ -402,6 +460,9 @@ void CL_DemoCompleted( void ) {
 			Com_Printf ("%i frames, %3.1f seconds: %3.1f fps\n", clc.timeDemoFrames,
 			time/1000.0, clc.timeDemoFrames*1000.0 / time);
 		}
+		if ( CL_TimeDemoProfiling() ) {
+			CL_WriteTimeDemoLog( time );
+		}
 	}
 
 	CL_Disconnect( qtrue );
@@ -418,6 +479,7 @@ void CL_ReadDemoMessage( void ) {
 	msg_t		buf;
 	byte		bufData[ MAX_MSGLEN ];
 	int			s;
+	int			start;
 
 	if ( !clc.demofile ) {
 		CL_DemoCompleted ();
@@ -458,7 +520,13 @@ void CL_ReadDemoMessage( void ) {
 
 	clc.lastPacketTime = cls.realtime;
 	buf.readcount = 0;
-	CL_ParseServerMessage( &buf );
+	if ( CL_TimeDemoProfiling() ) {
+		start = Sys_Microseconds();
+		CL_ParseServerMessage( &buf );
+		clc.timeDemoProfile.parse += Sys_Microseconds() - start;
+	} else {
+		CL_ParseServerMessage( &buf );
+	}
 }
 
 /*
@@ -736,6 +804,10 @@ void CL_Disconnect( qboolean showMainMenu ) {
 		FS_FCloseFile( clc.download );
 		clc.download = 0;
 	}
+	if (clc.httpDownload) {
+		Sys_EndHTTPDownload();
+		clc.httpDownload = qfalse;
+	}
 	*clc.downloadTempName = *clc.downloadName = 0;
 	Cvar_Set( "cl_downloadName", "" );
 
@@ -1366,6 +1438,90 @@ void CL_DownloadsComplete( void ) {
 	CL_WritePacket();
 }
 
+/*
+=================
+CL_BeginHTTPDownload
+
+Fetches the file from the server's sv_dlURL instead of the netchan, if it
+has one. The remote name is the "baseq3/foo.pk3" path the server lists.
+=================
+*/
+static qboolean CL_BeginHTTPDownload( const char *remoteName ) {
+	const char	*url, *osPath;
+
+	url = Cvar_VariableString( "sv_dlURL" );
+	if ( !url[0] ) {
+		return qfalse;
+	}
+
+	osPath = FS_SV_CreateOSPath( clc.downloadTempName );
+	if ( !osPath ) {
+		return qfalse;
+	}
+
+	if ( url[strlen( url ) - 1] == '/' ) {
+		url = va( "%s%s", url, remoteName );
+	} else {
+		url = va( "%s/%s", url, remoteName );
+	}
+	if ( !Sys_BeginHTTPDownload( url, osPath ) ) {
+		return qfalse;
+	}
+
+	Com_Printf( "Downloading %s\n", url );
+	clc.httpDownload = qtrue;
+	return qtrue;
+}
+
+/*
+=================
+CL_CheckHTTPDownload
+
+Called every frame, finishes the HTTP download once its thread is done
+and falls back to the netchan if it failed
+=================
+*/
+void CL_CheckHTTPDownload( void ) {
+	httpDownloadStatus_t	status;
+	int						count, size;
+
+	if ( !clc.httpDownload ) {
+		return;
+	}
+
+	status = Sys_HTTPDownloadStatus( &count, &size );
+	if ( size >= 0 && size != clc.downloadSize ) {
+		clc.downloadSize = size;
+		Cvar_SetValue( "cl_downloadSize", size );
+	}
+	if ( count != clc.downloadCount ) {
+		clc.downloadCount = count;
+		Cvar_SetValue( "cl_downloadCount", count );
+	}
+
+	if ( status == HTTPDL_RUNNING ) {
+		return;
+	}
+
+	Sys_EndHTTPDownload();
+	clc.httpDownload = qfalse;
+
+	if ( status != HTTPDL_DONE ) {
+		Com_Printf( "HTTP download of %s failed, asking the server\n", Cvar_VariableString( "cl_downloadName" ) );
+		clc.downloadBlock = 0;
+		clc.downloadCount = 0;
+		Cvar_Set( "cl_downloadCount", "0" );
+		CL_AddReliableCommand( va("download %s", Cvar_VariableString( "cl_downloadName" )) );
+		return;
+	}
+
+	FS_SV_Rename( clc.downloadTempName, clc.downloadName );
+	*clc.downloadTempName = *clc.downloadName = 0;
+	Cvar_Set( "cl_downloadName", "" );
+
+	CL_NextDownload();
+}
+
 /*
 =================
 CL_BeginDownload
@@ -1393,6 +1549,10 @@ void CL_BeginDownload( const char *localName, const char *remoteName ) {
 	clc.downloadBlock = 0; // Starting new file
 	clc.downloadCount = 0;
 
+	if ( CL_BeginHTTPDownload( remoteName ) ) {
+		return;
+	}
+
 	CL_AddReliableCommand( va("download %s", remoteName) );
 }
 
@@ -2043,6 +2203,9 @@ void CL_Frame ( int msec ) {
 	// drop the connection
 	CL_CheckTimeout();
 
+	// finish or fall back from a download over sv_dlURL
+	CL_CheckHTTPDownload();
+
 	// send intentions now
 	CL_SendCmd();
 
@@ -2292,6 +2455,7 @@ void CL_Init( void ) {
 	cl_activeAction = Cvar_Get( "activeAction", "", CVAR_TEMP );
 
 	cl_timedemo = Cvar_Get ("timedemo", "0", 0);
+	cl_timedemoLog = Cvar_Get ("cl_timedemoLog", "", 0);
 	cl_avidemo = Cvar_Get ("cl_avidemo", "0", 0);
 	cl_forceavidemo = Cvar_Get ("cl_forceavidemo", "0", 0);
 
@@ -2379,6 +2543,7 @@ void CL_Init( void ) {
 	Cmd_AddCommand ("record", CL_Record_f);
 	Cmd_AddCommand ("demo", CL_PlayDemo_f);
 	Cmd_AddCommand ("cinematic", CL_PlayCinematic_f);
+	Cmd_AddCommand ("cinbench", CL_CinematicBench_f);
 	Cmd_AddCommand ("stoprecord", CL_StopRecord_f);
 	Cmd_AddCommand ("connect", CL_Connect_f);
 	Cmd_AddCommand ("reconnect", CL_Reconnect_f);
@@ -2437,6 +2602,7 @@ void CL_Shutdown( void ) {
 	Cmd_RemoveCommand ("record");
 	Cmd_RemoveCommand ("demo");
 	Cmd_RemoveCommand ("cinematic");
+	Cmd_RemoveCommand ("cinbench");
 	Cmd_RemoveCommand ("stoprecord");
 	Cmd_RemoveCommand ("connect");
 	Cmd_RemoveCommand ("localservers");
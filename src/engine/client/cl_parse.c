@@ -643,7 +643,14 @@ void CL_ParseServerMessage( msg_t *msg ) {
 			CL_ParseGamestate( msg );
 			break;
 		case svc_snapshot:
-			CL_ParseSnapshot( msg );
+			if ( CL_TimeDemoProfiling() ) {
+				int		start = Sys_Microseconds();
+
+				CL_ParseSnapshot( msg );
+				clc.timeDemoProfile.snapshots += Sys_Microseconds() - start;
+			} else {
+				CL_ParseSnapshot( msg );
+			}
 			break;
 		case svc_download:
 			CL_ParseDownload( msg );
@@ -518,6 +518,8 @@ text to the screen.
 */
 void SCR_UpdateScreen( void ) {
 	static int	recursive;
+	qboolean	profiling;
+	int			start, endFrame, usec;
 
 	if ( !scr_initialized ) {
 		return;				// not initialized yet
@@ -528,6 +530,9 @@ void SCR_UpdateScreen( void ) {
 	}
 	recursive = 1;
 
+	profiling = ( CL_TimeDemoProfiling() && clc.demoplaying && cls.state == CA_ACTIVE ) ? qtrue : qfalse;
+	start = profiling ? Sys_Microseconds() : 0;
+
 	// if running in stereo, we need to draw the frame twice
 	if ( cls.glconfig.stereoEnabled ) {
 		SCR_DrawScreenField( STEREO_LEFT );
@@ -536,12 +541,30 @@ void SCR_UpdateScreen( void ) {
 		SCR_DrawScreenField( STEREO_CENTER );
 	}
 
+	endFrame = profiling ? Sys_Microseconds() : 0;
+
 	if ( com_speeds->integer ) {
 		re.EndFrame( &time_frontend, &time_backend );
 	} else {
 		re.EndFrame( NULL, NULL );
 	}
 
+	if ( profiling ) {
+		timeDemoProfile_t	*p = &clc.timeDemoProfile;
+
+		usec = Sys_Microseconds();
+		p->endFrame += usec - endFrame;
+		usec -= start;
+		if ( !p->frameCount || usec < p->frameMin ) {
+			p->frameMin = usec;
+		}
+		if ( usec > p->frameMax ) {
+			p->frameMax = usec;
+		}
+		p->frameTotal += usec;
+		p->frameCount++;
+	}
+
 	recursive = 0;
 }
 
@@ -146,6 +146,20 @@ demo through a file.
 =============================================================================
 */
 
+// where the time of a profiled timedemo went, in microseconds
+typedef struct {
+	int			parse;			// CL_ParseServerMessage
+	int			snapshots;		// CL_ParseSnapshot, mostly delta decoding
+	int			cgame;			// CG_DRAW_ACTIVE_FRAME, including the three below
+	int			collision;		// cgame traces and contents, mostly prediction
+	int			marks;			// cgame mark fragment clipping
+	int			scene;			// renderer front end
+	int			endFrame;		// handing the frame to the back end
+	int			frameMin;		// whole SCR_UpdateScreen
+	int			frameMax;
+	int			frameTotal;
+	int			frameCount;
+} timeDemoProfile_t;
 
 typedef struct {
 
@@ -189,6 +203,7 @@ typedef struct {
 	int			downloadSize;	// how many bytes we got
 	char		downloadList[MAX_INFO_STRING]; // list of paks we need to download
 	qboolean	downloadRestart;	// if true, we need to do another FS_Restart because we downloaded a pak
+	qboolean	httpDownload;		// the current download comes from sv_dlURL, not the netchan
 
 	// demo information
 	char		demoName[MAX_QPATH];
@@ -202,6 +217,7 @@ typedef struct {
 	int			timeDemoFrames;		// counter of rendered frames
 	int			timeDemoStart;		// cls.realtime before first frame
 	int			timeDemoBaseTime;	// each frame will be at this time + frameNum * 50
+	timeDemoProfile_t	timeDemoProfile;	// only filled in when CL_TimeDemoProfiling
 
 	// big stuff at end of structure so most offsets are 15 bits or less
 	netchan_t	netchan;
@@ -342,6 +358,7 @@ extern	cvar_t	*m_side;
 extern	cvar_t	*m_filter;
 
 extern	cvar_t	*cl_timedemo;
+extern	cvar_t	*cl_timedemoLog;
 
 extern	cvar_t	*cl_activeAction;
 
@@ -368,9 +385,11 @@ void CL_Snd_Restart_f (void);
 void CL_StartDemoLoop( void );
 void CL_NextDemo( void );
 void CL_ReadDemoMessage( void );
+qboolean CL_TimeDemoProfiling( void );
 
 void CL_InitDownloads(void);
 void CL_NextDownload(void);
+void CL_CheckHTTPDownload(void);
 
 void CL_GetPing( int n, char *buf, int buflen, int *pingtime );
 void CL_GetPingInfo( int n, char *buf, int buflen );
@@ -476,6 +495,7 @@ void	SCR_DrawSmallChar( int x, int y, int ch );
 //
 
 void CL_PlayCinematic_f( void );
+void CL_CinematicBench_f( void );
 void SCR_DrawCinematic (void);
 void SCR_RunCinematic (void);
 void SCR_StopCinematic (void);
@@ -40,10 +40,50 @@ void S_Update_();
 void S_StopAllSounds(void);
 void S_UpdateBackgroundTrack( void );
 
-static fileHandle_t s_backgroundFile;
-static wavinfo_t	s_backgroundInfo;
+typedef enum {
+	SCMD_START_SOUND,
+	SCMD_CLEAR_LOOPING,
+	SCMD_ADD_LOOPING,
+	SCMD_ADD_REAL_LOOPING,
+	SCMD_STOP_LOOPING,
+	SCMD_UPDATE_ENTITY,
+	SCMD_RESPATIALIZE
+} soundCommandType_t;
+
+// a client call queued for the mixer thread
+typedef struct {
+	soundCommandType_t	type;
+	int			entityNum;
+	int			entchannel;
+	int			framecount;
+	qboolean	fixedOrigin;
+	qboolean	local;			// entityNum is the listener at the time it runs
+	qboolean	killall;
+	sfx_t		*sfx;
+	vec3_t		origin;			// also the listener head
+	vec3_t		velocity;
+	vec3_t		axis[3];
+} soundCommand_t;
+
+static soundCommand_t *S_GetCommand( soundCommandType_t type );
+static void S_SubmitCommand( void );
+static void S_LockMixer( void );
+static void S_UnlockMixer( void );
+static void S_MixThread( void );
+
+#define	STREAM_READAHEAD	0x10000		// bytes kept ahead of the reader
+
+// a wav played straight from the file, read ahead by the stream thread
+typedef struct {
+	fileHandle_t	file;
+	wavinfo_t		info;
+	int				samples;		// not read yet
+} streamSource_t;
+
+static void S_CloseStream( streamSource_t *stream );
+
+static streamSource_t	s_backgroundStream;
 //int			s_nextWavChunk;
-static int			s_backgroundSamples;
 static char		s_backgroundLoop[MAX_QPATH];
 //static char		s_backgroundMusic[MAX_QPATH]; //TTimo: unused
 
@@ -91,6 +131,11 @@ cvar_t		*s_mixPreStep;
 cvar_t		*s_musicVolume;
 cvar_t		*s_separation;
 cvar_t		*s_doppler;
+cvar_t		*s_mixThread;
+
+// set when the channels are owned by the mixer thread
+static qboolean	s_mixThreadActive;
+static int		s_droppedSounds;
 
 static loopSound_t		loopSounds[MAX_GENTITIES];
 static	channel_t		*freelist = NULL;
@@ -119,7 +164,7 @@ void S_SoundInfo_f(void) {
 		Com_Printf("%5d submission_chunk\n", dma.submission_chunk);
 		Com_Printf("%5d speed\n", dma.speed);
 		Com_Printf("0x%x dma buffer\n", dma.buffer);
-		if ( s_backgroundFile ) {
+		if ( s_backgroundStream.file ) {
 			Com_Printf("Background file: %s\n", s_backgroundLoop );
 		} else {
 			Com_Printf("No background file.\n" );
@@ -152,6 +197,7 @@ void S_Init( void ) {
 	s_mixPreStep = Cvar_Get ("s_mixPreStep", "0.05", CVAR_ARCHIVE);
 	s_show = Cvar_Get ("s_show", "0", CVAR_CHEAT);
 	s_testsound = Cvar_Get ("s_testsound", "0", CVAR_CHEAT);
+	s_mixThread = Cvar_Get ("s_mixThread", "0", CVAR_ARCHIVE | CVAR_LATCH);
 
 	cv = Cvar_Get ("s_initsound", "1", 0);
 	if ( !cv->integer ) {
@@ -165,6 +211,7 @@ void S_Init( void ) {
 	Cmd_AddCommand("s_list", S_SoundList_f);
 	Cmd_AddCommand("s_info", S_SoundInfo_f);
 	Cmd_AddCommand("s_stop", S_StopAllSounds);
+	Cmd_AddCommand("s_mixbench", S_MixBench_f);
 
 	r = SNDDMA_Init();
 	Com_Printf("------------------------------------\n");
@@ -182,6 +229,13 @@ void S_Init( void ) {
 		S_StopAllSounds ();
 
 		S_SoundInfo_f();
+
+		if ( s_mixThread->integer ) {
+			s_mixThreadActive = SNDDMA_BeginMixThread( S_MixThread );
+			if ( !s_mixThreadActive ) {
+				Com_Printf( "couldn't start the mixer thread\n" );
+			}
+		}
 	}
 
 }
@@ -230,6 +284,11 @@ void S_Shutdown( void ) {
 		return;
 	}
 
+	if ( s_mixThreadActive ) {
+		SNDDMA_EndMixThread();
+		s_mixThreadActive = qfalse;
+	}
+
 	SNDDMA_Shutdown();
 
 	s_soundStarted = 0;
@@ -239,6 +298,7 @@ void S_Shutdown( void ) {
 	Cmd_RemoveCommand("stopsound");
 	Cmd_RemoveCommand("soundlist");
 	Cmd_RemoveCommand("soundinfo");
+	Cmd_RemoveCommand("s_mixbench");
 }
 
 
@@ -357,8 +417,10 @@ are no longer valid.
 ===================
 */
 void S_DisableSounds( void ) {
+	S_LockMixer();
 	S_StopAllSounds();
 	s_soundMuted = qtrue;
+	S_UnlockMixer();
 }
 
 /*
@@ -371,7 +433,9 @@ void S_BeginRegistration( void ) {
 	s_soundMuted = qfalse;		// we can play again
 
 	if (s_numSfx == 0) {
+		S_LockMixer();
 		SND_setup();
+		S_UnlockMixer();
 
 		s_numSfx = 0;
 		Com_Memset( s_knownSfx, 0, sizeof( s_knownSfx ) );
@@ -411,10 +475,13 @@ sfxHandle_t	S_RegisterSound( const char *name, qboolean compressed ) {
 		return sfx - s_knownSfx;
 	}
 
+	// loading may page out sounds that are playing
+	S_LockMixer();
 	sfx->inMemory = qfalse;
 	sfx->soundCompressed = compressed;
 
   S_memoryLoad(sfx);
+	S_UnlockMixer();
 
 	if ( sfx->defaultSound ) {
 		Com_Printf( S_COLOR_YELLOW "WARNING: could not find %s - using default\n", sfx->soundName );
@@ -502,42 +569,16 @@ void S_SpatializeOrigin (vec3_t origin, int master_vol, int *left_vol, int *righ
 
 /*
 ====================
-S_StartSound
+S_StartSound_
 
-Validates the parms and ques the sound up
-if pos is NULL, the sound will be dynamically sourced from the entity
-Entchannel 0 will never override a playing sound
+Picks a channel for an already validated and loaded sound
 ====================
 */
-void S_StartSound(vec3_t origin, int entityNum, int entchannel, sfxHandle_t sfxHandle ) {
+static void S_StartSound_( const vec3_t origin, int entityNum, int entchannel, sfx_t *sfx ) {
 	channel_t	*ch;
-	sfx_t		*sfx;
   int i, oldest, chosen, time;
   int	inplay, allowed;
 
-	if ( !s_soundStarted || s_soundMuted ) {
-		return;
-	}
-
-	if ( !origin && ( entityNum < 0 || entityNum > MAX_GENTITIES ) ) {
-		Com_Error( ERR_DROP, "S_StartSound: bad entitynum %i", entityNum );
-	}
-
-	if ( sfxHandle < 0 || sfxHandle >= s_numSfx ) {
-		Com_Printf( S_COLOR_YELLOW, "S_StartSound: handle %i out of range\n", sfxHandle );
-		return;
-	}
-
-	sfx = &s_knownSfx[ sfxHandle ];
-
-	if (sfx->inMemory == qfalse) {
-		S_memoryLoad(sfx);
-	}
-
-	if ( s_show->integer == 1 ) {
-		Com_Printf( "%i : %s\n", s_paintedtime, sfx->soundName );
-	}
-
 	time = Com_Milliseconds();
 
 //	Com_Printf("playing %s\n", sfx->soundName);
@@ -598,7 +639,11 @@ void S_StartSound(vec3_t origin, int entityNum, int entchannel, sfxHandle_t sfxH
 					}
 				}
 				if (chosen == -1) {
-					Com_Printf("dropping sound\n");
+					if ( s_mixThreadActive ) {
+						s_droppedSounds++;	// reported by S_Update
+					} else {
+						Com_Printf("dropping sound\n");
+					}
 					return;
 				}
 			}
@@ -624,6 +669,76 @@ void S_StartSound(vec3_t origin, int entityNum, int entchannel, sfxHandle_t sfxH
 	ch->doppler = qfalse;
 }
 
+/*
+====================
+S_LoadSfx
+
+Pages a sound back in before it is handed to the mixer
+====================
+*/
+static sfx_t *S_LoadSfx( sfxHandle_t sfxHandle ) {
+	sfx_t	*sfx;
+
+	sfx = &s_knownSfx[ sfxHandle ];
+
+	if (sfx->inMemory == qfalse) {
+		S_LockMixer();
+		S_memoryLoad(sfx);
+		S_UnlockMixer();
+	}
+
+	return sfx;
+}
+
+/*
+====================
+S_StartSound
+
+Validates the parms and ques the sound up
+if pos is NULL, the sound will be dynamically sourced from the entity
+Entchannel 0 will never override a playing sound
+====================
+*/
+void S_StartSound(vec3_t origin, int entityNum, int entchannel, sfxHandle_t sfxHandle ) {
+	sfx_t		*sfx;
+	soundCommand_t	*cmd;
+
+	if ( !s_soundStarted || s_soundMuted ) {
+		return;
+	}
+
+	if ( !origin && ( entityNum < 0 || entityNum > MAX_GENTITIES ) ) {
+		Com_Error( ERR_DROP, "S_StartSound: bad entitynum %i", entityNum );
+	}
+
+	if ( sfxHandle < 0 || sfxHandle >= s_numSfx ) {
+		Com_Printf( S_COLOR_YELLOW, "S_StartSound: handle %i out of range\n", sfxHandle );
+		return;
+	}
+
+	sfx = S_LoadSfx( sfxHandle );
+
+	if ( s_show->integer == 1 ) {
+		Com_Printf( "%i : %s\n", s_paintedtime, sfx->soundName );
+	}
+
+	if ( !s_mixThreadActive ) {
+		S_StartSound_( origin, entityNum, entchannel, sfx );
+		return;
+	}
+
+	cmd = S_GetCommand( SCMD_START_SOUND );
+	cmd->fixedOrigin = ( origin != NULL );
+	if ( origin ) {
+		VectorCopy( origin, cmd->origin );
+	}
+	cmd->entityNum = entityNum;
+	cmd->entchannel = entchannel;
+	cmd->sfx = sfx;
+	cmd->local = qfalse;
+	S_SubmitCommand();
+}
+
 
 /*
 ==================
@@ -631,6 +746,8 @@ S_StartLocalSound
 ==================
 */
 void S_StartLocalSound( sfxHandle_t sfxHandle, int channelNum ) {
+	soundCommand_t	*cmd;
+
 	if ( !s_soundStarted || s_soundMuted ) {
 		return;
 	}
@@ -640,7 +757,19 @@ void S_StartLocalSound( sfxHandle_t sfxHandle, int channelNum ) {
 		return;
 	}
 
-	S_StartSound (NULL, listener_number, channelNum, sfxHandle );
+	if ( !s_mixThreadActive ) {
+		S_StartSound (NULL, listener_number, channelNum, sfxHandle );
+		return;
+	}
+
+	// the listener is only known once the queued respatialize has run
+	cmd = S_GetCommand( SCMD_START_SOUND );
+	cmd->fixedOrigin = qfalse;
+	cmd->entityNum = 0;
+	cmd->entchannel = channelNum;
+	cmd->sfx = S_LoadSfx( sfxHandle );
+	cmd->local = qtrue;
+	S_SubmitCommand();
 }
 
 
@@ -658,6 +787,8 @@ void S_ClearSoundBuffer( void ) {
 	if (!s_soundStarted)
 		return;
 
+	S_LockMixer();
+
 	// stop looping sounds
 	Com_Memset(loopSounds, 0, MAX_GENTITIES*sizeof(loopSound_t));
 	Com_Memset(loop_channels, 0, MAX_CHANNELS*sizeof(channel_t));
@@ -680,6 +811,8 @@ void S_ClearSoundBuffer( void ) {
     // https://zerowing.idsoftware.com/bugzilla/show_bug.cgi?id=371
 		Snd_Memset(dma.buffer, clear, dma.samples * dma.samplebits/8);
 	SNDDMA_Submit ();
+
+	S_UnlockMixer();
 }
 
 /*
@@ -692,10 +825,14 @@ void S_StopAllSounds(void) {
 		return;
 	}
 
+	S_LockMixer();
+
 	// stop the background music
 	S_StopBackgroundTrack();
 
 	S_ClearSoundBuffer ();
+
+	S_UnlockMixer();
 }
 
 /*
@@ -706,59 +843,24 @@ continuous looping sounds are added each frame
 ==============================================================
 */
 
-void S_StopLoopingSound(int entityNum) {
+static void S_StopLoopingSound_( int entityNum ) {
 	loopSounds[entityNum].active = qfalse;
 //	loopSounds[entityNum].sfx = 0;
 	loopSounds[entityNum].kill = qfalse;
 }
 
-/*
-==================
-S_ClearLoopingSounds
-
-==================
-*/
-void S_ClearLoopingSounds( qboolean killall ) {
+static void S_ClearLoopingSounds_( qboolean killall ) {
 	int i;
 	for ( i = 0 ; i < MAX_GENTITIES ; i++) {
 		if (killall || loopSounds[i].kill == qtrue || (loopSounds[i].sfx && loopSounds[i].sfx->soundLength == 0)) {
 			loopSounds[i].kill = qfalse;
-			S_StopLoopingSound(i);
+			S_StopLoopingSound_(i);
 		}
 	}
 	numLoopChannels = 0;
 }
 
-/*
-==================
-S_AddLoopingSound
-
-Called during entity generation for a frame
-Include velocity in case I get around to doing doppler...
-==================
-*/
-void S_AddLoopingSound( int entityNum, const vec3_t origin, const vec3_t velocity, sfxHandle_t sfxHandle ) {
-	sfx_t *sfx;
-
-	if ( !s_soundStarted || s_soundMuted ) {
-		return;
-	}
-
-	if ( sfxHandle < 0 || sfxHandle >= s_numSfx ) {
-		Com_Printf( S_COLOR_YELLOW, "S_AddLoopingSound: handle %i out of range\n", sfxHandle );
-		return;
-	}
-
-	sfx = &s_knownSfx[ sfxHandle ];
-
-	if (sfx->inMemory == qfalse) {
-		S_memoryLoad(sfx);
-	}
-
-	if ( !sfx->soundLength ) {
-		Com_Error( ERR_DROP, "%s has length 0", sfx->soundName );
-	}
-
+static void S_AddLoopingSound_( int entityNum, const vec3_t origin, const vec3_t velocity, sfx_t *sfx, int framecount ) {
 	VectorCopy( origin, loopSounds[entityNum].origin );
 	VectorCopy( velocity, loopSounds[entityNum].velocity );
 	loopSounds[entityNum].active = qtrue;
@@ -776,7 +878,7 @@ void S_AddLoopingSound( int entityNum, const vec3_t origin, const vec3_t velocit
 		lena = DistanceSquared(loopSounds[listener_number].origin, loopSounds[entityNum].origin);
 		VectorAdd(loopSounds[entityNum].origin, loopSounds[entityNum].velocity, out);
 		lenb = DistanceSquared(loopSounds[listener_number].origin, out);
-		if ((loopSounds[entityNum].framenum+1) != cls.framecount) {
+		if ((loopSounds[entityNum].framenum+1) != framecount) {
 			loopSounds[entityNum].oldDopplerScale = 1.0;
 		} else {
 			loopSounds[entityNum].oldDopplerScale = loopSounds[entityNum].dopplerScale;
@@ -787,38 +889,10 @@ void S_AddLoopingSound( int entityNum, const vec3_t origin, const vec3_t velocit
 		}
 	}
 
-	loopSounds[entityNum].framenum = cls.framecount;
+	loopSounds[entityNum].framenum = framecount;
 }
 
-/*
-==================
-S_AddLoopingSound
-
-Called during entity generation for a frame
-Include velocity in case I get around to doing doppler...
-==================
-*/
-void S_AddRealLoopingSound( int entityNum, const vec3_t origin, const vec3_t velocity, sfxHandle_t sfxHandle ) {
-	sfx_t *sfx;
-
-	if ( !s_soundStarted || s_soundMuted ) {
-		return;
-	}
-
-	if ( sfxHandle < 0 || sfxHandle >= s_numSfx ) {
-		Com_Printf( S_COLOR_YELLOW, "S_AddRealLoopingSound: handle %i out of range\n", sfxHandle );
-		return;
-	}
-
-	sfx = &s_knownSfx[ sfxHandle ];
-
-	if (sfx->inMemory == qfalse) {
-		S_memoryLoad(sfx);
-	}
-
-	if ( !sfx->soundLength ) {
-		Com_Error( ERR_DROP, "%s has length 0", sfx->soundName );
-	}
+static void S_AddRealLoopingSound_( int entityNum, const vec3_t origin, const vec3_t velocity, sfx_t *sfx ) {
 	VectorCopy( origin, loopSounds[entityNum].origin );
 	VectorCopy( velocity, loopSounds[entityNum].velocity );
 	loopSounds[entityNum].sfx = sfx;
@@ -944,12 +1018,12 @@ portable_samplepair_t *S_GetRawSamplePointer() {
 
 /*
 ============
-S_RawSamples
+S_RawSamples_
 
 Music streaming
 ============
 */
-void S_RawSamples( int samples, int rate, int width, int s_channels, const byte *data, float volume ) {
+static void S_RawSamples_( int samples, int rate, int width, int s_channels, const byte *data, float volume ) {
 	int		i;
 	int		src, dst;
 	float	scale;
@@ -1044,39 +1118,26 @@ void S_RawSamples( int samples, int rate, int width, int s_channels, const byte
 	}
 }
 
-//=============================================================================
-
-/*
-=====================
-S_UpdateEntityPosition
-
-let the sound system know where an entity currently is
-======================
-*/
-void S_UpdateEntityPosition( int entityNum, const vec3_t origin ) {
-	if ( entityNum < 0 || entityNum > MAX_GENTITIES ) {
-		Com_Error( ERR_DROP, "S_UpdateEntityPosition: bad entitynum %i", entityNum );
-	}
-	VectorCopy( origin, loopSounds[entityNum].origin );
+void S_RawSamples( int samples, int rate, int width, int s_channels, const byte *data, float volume ) {
+	S_LockMixer();
+	S_RawSamples_( samples, rate, width, s_channels, data, volume );
+	S_UnlockMixer();
 }
 
+//=============================================================================
 
 /*
 ============
-S_Respatialize
+S_Respatialize_
 
 Change the volumes of all the playing sounds for changes in their positions
 ============
 */
-void S_Respatialize( int entityNum, const vec3_t head, vec3_t axis[3], int inwater ) {
+static void S_Respatialize_( int entityNum, const vec3_t head, vec3_t axis[3] ) {
 	int			i;
 	channel_t	*ch;
 	vec3_t		origin;
 
-	if ( !s_soundStarted || s_soundMuted ) {
-		return;
-	}
-
 	listener_number = entityNum;
 	VectorCopy(head, listener_origin);
 	VectorCopy(axis[0], listener_axis[0]);
@@ -1108,6 +1169,293 @@ void S_Respatialize( int entityNum, const vec3_t head, vec3_t axis[3], int inwat
 	S_AddLoopSounds ();
 }
 
+/*
+===============================================================================
+
+mixer thread commands
+
+With s_mixThread set, the channels and looping sounds belong to the mixer
+thread. The per-frame calls from the client are queued in a single
+producer, single consumer ring that the mixer drains before every paint.
+Anything that loads or frees sound data or writes the raw sample buffer
+takes the mixer lock instead, which drains the ring first so the order
+of calls is kept.
+
+===============================================================================
+*/
+
+#define	MAX_SOUND_COMMANDS	4096		// must be a power of two
+
+static soundCommand_t	s_commands[MAX_SOUND_COMMANDS];
+static volatile int		s_commandHead;	// only written by the client
+static volatile int		s_commandTail;	// only written with the mixer locked
+
+/*
+==================
+S_RunCommands
+
+Must be called with the mixer locked
+==================
+*/
+static void S_RunCommands( void ) {
+	soundCommand_t	*cmd;
+
+	while ( s_commandTail != s_commandHead ) {
+		cmd = &s_commands[ s_commandTail & (MAX_SOUND_COMMANDS-1) ];
+
+		switch ( cmd->type ) {
+		case SCMD_START_SOUND:
+			S_StartSound_( cmd->fixedOrigin ? cmd->origin : NULL,
+				cmd->local ? listener_number : cmd->entityNum, cmd->entchannel, cmd->sfx );
+			break;
+		case SCMD_CLEAR_LOOPING:
+			S_ClearLoopingSounds_( cmd->killall );
+			break;
+		case SCMD_ADD_LOOPING:
+			S_AddLoopingSound_( cmd->entityNum, cmd->origin, cmd->velocity, cmd->sfx, cmd->framecount );
+			break;
+		case SCMD_ADD_REAL_LOOPING:
+			S_AddRealLoopingSound_( cmd->entityNum, cmd->origin, cmd->velocity, cmd->sfx );
+			break;
+		case SCMD_STOP_LOOPING:
+			S_StopLoopingSound_( cmd->entityNum );
+			break;
+		case SCMD_UPDATE_ENTITY:
+			VectorCopy( cmd->origin, loopSounds[cmd->entityNum].origin );
+			break;
+		case SCMD_RESPATIALIZE:
+			S_Respatialize_( cmd->entityNum, cmd->origin, cmd->axis );
+			break;
+		}
+
+		// volatile store, the slot can be reused after this
+		s_commandTail++;
+	}
+}
+
+/*
+==================
+S_GetCommand
+
+Returns the next free slot, which S_SubmitCommand publishes
+==================
+*/
+static soundCommand_t *S_GetCommand( soundCommandType_t type ) {
+	soundCommand_t	*cmd;
+
+	if ( s_commandHead - s_commandTail >= MAX_SOUND_COMMANDS ) {
+		// the mixer fell behind, so drain the ring from here
+		S_LockMixer();
+		S_UnlockMixer();
+	}
+
+	cmd = &s_commands[ s_commandHead & (MAX_SOUND_COMMANDS-1) ];
+	cmd->type = type;
+	return cmd;
+}
+
+static void S_SubmitCommand( void ) {
+	// volatile store, so the command is visible before the new head
+	s_commandHead++;
+}
+
+static void S_LockMixer( void ) {
+	if ( s_mixThreadActive ) {
+		SNDDMA_LockMixer();
+		S_RunCommands();
+	}
+}
+
+static void S_UnlockMixer( void ) {
+	if ( s_mixThreadActive ) {
+		SNDDMA_UnlockMixer();
+	}
+}
+
+/*
+==================
+S_MixThread
+
+Runs on the mixer thread with the mixer locked
+==================
+*/
+static void S_MixThread( void ) {
+	S_RunCommands();
+	S_Update_();
+}
+
+/*
+==============================================================
+
+client entry points for the channel state
+
+==============================================================
+*/
+
+void S_StopLoopingSound( int entityNum ) {
+	soundCommand_t	*cmd;
+
+	if ( !s_mixThreadActive ) {
+		S_StopLoopingSound_( entityNum );
+		return;
+	}
+
+	cmd = S_GetCommand( SCMD_STOP_LOOPING );
+	cmd->entityNum = entityNum;
+	S_SubmitCommand();
+}
+
+/*
+==================
+S_ClearLoopingSounds
+
+==================
+*/
+void S_ClearLoopingSounds( qboolean killall ) {
+	soundCommand_t	*cmd;
+
+	if ( !s_mixThreadActive ) {
+		S_ClearLoopingSounds_( killall );
+		return;
+	}
+
+	cmd = S_GetCommand( SCMD_CLEAR_LOOPING );
+	cmd->killall = killall;
+	S_SubmitCommand();
+}
+
+/*
+==================
+S_AddLoopingSound
+
+Called during entity generation for a frame
+Include velocity in case I get around to doing doppler...
+==================
+*/
+void S_AddLoopingSound( int entityNum, const vec3_t origin, const vec3_t velocity, sfxHandle_t sfxHandle ) {
+	sfx_t *sfx;
+	soundCommand_t	*cmd;
+
+	if ( !s_soundStarted || s_soundMuted ) {
+		return;
+	}
+
+	if ( sfxHandle < 0 || sfxHandle >= s_numSfx ) {
+		Com_Printf( S_COLOR_YELLOW, "S_AddLoopingSound: handle %i out of range\n", sfxHandle );
+		return;
+	}
+
+	sfx = S_LoadSfx( sfxHandle );
+
+	if ( !sfx->soundLength ) {
+		Com_Error( ERR_DROP, "%s has length 0", sfx->soundName );
+	}
+
+	if ( !s_mixThreadActive ) {
+		S_AddLoopingSound_( entityNum, origin, velocity, sfx, cls.framecount );
+		return;
+	}
+
+	cmd = S_GetCommand( SCMD_ADD_LOOPING );
+	cmd->entityNum = entityNum;
+	VectorCopy( origin, cmd->origin );
+	VectorCopy( velocity, cmd->velocity );
+	cmd->sfx = sfx;
+	cmd->framecount = cls.framecount;
+	S_SubmitCommand();
+}
+
+/*
+==================
+S_AddRealLoopingSound
+
+Called during entity generation for a frame
+Include velocity in case I get around to doing doppler...
+==================
+*/
+void S_AddRealLoopingSound( int entityNum, const vec3_t origin, const vec3_t velocity, sfxHandle_t sfxHandle ) {
+	sfx_t *sfx;
+	soundCommand_t	*cmd;
+
+	if ( !s_soundStarted || s_soundMuted ) {
+		return;
+	}
+
+	if ( sfxHandle < 0 || sfxHandle >= s_numSfx ) {
+		Com_Printf( S_COLOR_YELLOW, "S_AddRealLoopingSound: handle %i out of range\n", sfxHandle );
+		return;
+	}
+
+	sfx = S_LoadSfx( sfxHandle );
+
+	if ( !sfx->soundLength ) {
+		Com_Error( ERR_DROP, "%s has length 0", sfx->soundName );
+	}
+
+	if ( !s_mixThreadActive ) {
+		S_AddRealLoopingSound_( entityNum, origin, velocity, sfx );
+		return;
+	}
+
+	cmd = S_GetCommand( SCMD_ADD_REAL_LOOPING );
+	cmd->entityNum = entityNum;
+	VectorCopy( origin, cmd->origin );
+	VectorCopy( velocity, cmd->velocity );
+	cmd->sfx = sfx;
+	S_SubmitCommand();
+}
+
+/*
+=====================
+S_UpdateEntityPosition
+
+let the sound system know where an entity currently is
+======================
+*/
+void S_UpdateEntityPosition( int entityNum, const vec3_t origin ) {
+	soundCommand_t	*cmd;
+
+	if ( entityNum < 0 || entityNum > MAX_GENTITIES ) {
+		Com_Error( ERR_DROP, "S_UpdateEntityPosition: bad entitynum %i", entityNum );
+	}
+
+	if ( !s_mixThreadActive ) {
+		VectorCopy( origin, loopSounds[entityNum].origin );
+		return;
+	}
+
+	cmd = S_GetCommand( SCMD_UPDATE_ENTITY );
+	cmd->entityNum = entityNum;
+	VectorCopy( origin, cmd->origin );
+	S_SubmitCommand();
+}
+
+/*
+============
+S_Respatialize
+============
+*/
+void S_Respatialize( int entityNum, const vec3_t head, vec3_t axis[3], int inwater ) {
+	soundCommand_t	*cmd;
+
+	if ( !s_soundStarted || s_soundMuted ) {
+		return;
+	}
+
+	if ( !s_mixThreadActive ) {
+		S_Respatialize_( entityNum, head, axis );
+		return;
+	}
+
+	cmd = S_GetCommand( SCMD_RESPATIALIZE );
+	cmd->entityNum = entityNum;
+	VectorCopy( head, cmd->origin );
+	VectorCopy( axis[0], cmd->axis[0] );
+	VectorCopy( axis[1], cmd->axis[1] );
+	VectorCopy( axis[2], cmd->axis[2] );
+	S_SubmitCommand();
+}
+
 
 /*
 ========================
@@ -1163,6 +1511,18 @@ void S_Update( void ) {
 		return;
 	}
 
+	if ( s_mixThreadActive && SNDDMA_DeviceLost() ) {
+		S_Shutdown();
+		return;
+	}
+
+	S_LockMixer();
+
+	if ( s_droppedSounds ) {
+		Com_Printf( "dropped %i sounds\n", s_droppedSounds );
+		s_droppedSounds = 0;
+	}
+
 	//
 	// debugging output
 	//
@@ -1179,11 +1539,16 @@ void S_Update( void ) {
 		Com_Printf ("----(%i)---- painted: %i\n", total, s_paintedtime);
 	}
 
-	// add raw data from streamed samples
+	S_UnlockMixer();
+
+	// add raw data from streamed samples, the file reads don't hold
+	// up the mixer thread
 	S_UpdateBackgroundTrack();
 
-	// mix some sound
-	S_Update_();
+	// mix some sound, unless the mixer thread is doing it
+	if ( !s_mixThreadActive ) {
+		S_Update_();
+	}
 }
 
 void S_GetSoundtime(void)
@@ -1206,7 +1571,11 @@ void S_GetSoundtime(void)
 		{	// time to chop things off to avoid 32 bit limits
 			buffers = 0;
 			s_paintedtime = fullsamples;
-			S_StopAllSounds ();
+			if ( s_mixThreadActive ) {
+				S_ClearSoundBuffer ();	// the music file is the client's
+			} else {
+				S_StopAllSounds ();
+			}
 		}
 	}
 	oldsamplepos = samplepos;
@@ -1283,6 +1652,9 @@ void S_Update_(void) {
 
 
 	SNDDMA_BeginPainting ();
+	if ( !dma.buffer ) {
+		return;		// couldn't lock the device
+	}
 
 	S_PaintChannels (endtime);
 
@@ -1411,19 +1783,116 @@ int S_FindWavChunk( fileHandle_t f, char *chunk ) {
 	return len;
 }
 
+/*
+======================
+S_OpenStream
+
+Opens a PCM wav and starts reading ahead on its sample data
+======================
+*/
+static qboolean S_OpenStream( streamSource_t *stream, const char *name ) {
+	int		len;
+	char	dump[16];
+
+	Com_Memset( stream, 0, sizeof( *stream ) );
+
+	// unique, so the stream thread has the file to itself
+	FS_FOpenFileRead( name, &stream->file, qtrue );
+	if ( !stream->file ) {
+		Com_Printf( S_COLOR_YELLOW "WARNING: couldn't open music file %s\n", name );
+		return qfalse;
+	}
+
+	// skip the riff wav header
+
+	FS_Read(dump, 12, stream->file);
+
+	if ( !S_FindWavChunk( stream->file, "fmt " ) ) {
+		Com_Printf( "No fmt chunk in %s\n", name );
+		S_CloseStream( stream );
+		return qfalse;
+	}
+
+	stream->info.format = FGetLittleShort( stream->file );
+	stream->info.channels = FGetLittleShort( stream->file );
+	stream->info.rate = FGetLittleLong( stream->file );
+	FGetLittleLong(  stream->file );
+	FGetLittleShort(  stream->file );
+	stream->info.width = FGetLittleShort( stream->file ) / 8;
+
+	if ( stream->info.format != WAV_FORMAT_PCM || stream->info.width * stream->info.channels <= 0 ) {
+		S_CloseStream( stream );
+		Com_Printf("Not a microsoft PCM format wav: %s\n", name);
+		return qfalse;
+	}
+
+	if ( stream->info.channels != 2 || stream->info.rate != 22050 ) {
+		Com_Printf(S_COLOR_YELLOW "WARNING: music file %s is not 22k stereo\n", name );
+	}
+
+	if ( ( len = S_FindWavChunk( stream->file, "data" ) ) == 0 ) {
+		S_CloseStream( stream );
+		Com_Printf("No data chunk in %s\n", name);
+		return qfalse;
+	}
+
+	stream->info.samples = len / (stream->info.width * stream->info.channels);
+	stream->samples = stream->info.samples;
+
+	Sys_BeginStreamedFile( stream->file, STREAM_READAHEAD );
+	return qtrue;
+}
+
+/*
+======================
+S_ReadStream
+
+Returns the number of samples read, which is only short of
+the request on a read error
+======================
+*/
+static int S_ReadStream( streamSource_t *stream, byte *buffer, int samples ) {
+	int		r;
+
+	if ( samples > stream->samples ) {
+		samples = stream->samples;
+	}
+	if ( samples <= 0 ) {
+		return 0;
+	}
+
+	r = Sys_StreamedRead( buffer, stream->info.width * stream->info.channels, samples, stream->file );
+	stream->samples -= r;
+	return r;
+}
+
+/*
+======================
+S_CloseStream
+======================
+*/
+static void S_CloseStream( streamSource_t *stream ) {
+	if ( !stream->file ) {
+		return;
+	}
+	Sys_EndStreamedFile( stream->file );
+	FS_FCloseFile( stream->file );
+	stream->file = 0;
+}
+
 /*
 ======================
 S_StopBackgroundTrack
 ======================
 */
 void S_StopBackgroundTrack( void ) {
-	if ( !s_backgroundFile ) {
+	if ( !s_backgroundStream.file ) {
 		return;
 	}
-	Sys_EndStreamedFile( s_backgroundFile );
-	FS_FCloseFile( s_backgroundFile );
-	s_backgroundFile = 0;
+	S_CloseStream( &s_backgroundStream );
+	S_LockMixer();
 	s_rawend = 0;
+	S_UnlockMixer();
 }
 
 /*
@@ -1432,8 +1901,6 @@ S_StartBackgroundTrack
 ======================
 */
 void S_StartBackgroundTrack( const char *intro, const char *loop ){
-	int		len;
-	char	dump[16];
 	char	name[MAX_QPATH];
 
 	if ( !intro ) {
@@ -1455,66 +1922,12 @@ void S_StartBackgroundTrack( const char *intro, const char *loop ){
 
 	// close the background track, but DON'T reset s_rawend
 	// if restarting the same back ground track
-	if ( s_backgroundFile ) {
-		Sys_EndStreamedFile( s_backgroundFile );
-		FS_FCloseFile( s_backgroundFile );
-		s_backgroundFile = 0;
-	}
-
-	//
-	// open up a wav file and get all the info
-	//
-	FS_FOpenFileRead( name, &s_backgroundFile, qtrue );
-	if ( !s_backgroundFile ) {
-		Com_Printf( S_COLOR_YELLOW "WARNING: couldn't open music file %s\n", name );
-		return;
-	}
-
-	// skip the riff wav header
-
-	FS_Read(dump, 12, s_backgroundFile);
-
-	if ( !S_FindWavChunk( s_backgroundFile, "fmt " ) ) {
-		Com_Printf( "No fmt chunk in %s\n", name );
-		FS_FCloseFile( s_backgroundFile );
-		s_backgroundFile = 0;
-		return;
-	}
-
-	// save name for soundinfo
-	s_backgroundInfo.format = FGetLittleShort( s_backgroundFile );
-	s_backgroundInfo.channels = FGetLittleShort( s_backgroundFile );
-	s_backgroundInfo.rate = FGetLittleLong( s_backgroundFile );
-	FGetLittleLong(  s_backgroundFile );
-	FGetLittleShort(  s_backgroundFile );
-	s_backgroundInfo.width = FGetLittleShort( s_backgroundFile ) / 8;
-
-	if ( s_backgroundInfo.format != WAV_FORMAT_PCM ) {
-		FS_FCloseFile( s_backgroundFile );
-		s_backgroundFile = 0;
-		Com_Printf("Not a microsoft PCM format wav: %s\n", name);
-		return;
-	}
-
-	if ( s_backgroundInfo.channels != 2 || s_backgroundInfo.rate != 22050 ) {
-		Com_Printf(S_COLOR_YELLOW "WARNING: music file %s is not 22k stereo\n", name );
-	}
-
-	if ( ( len = S_FindWavChunk( s_backgroundFile, "data" ) ) == 0 ) {
-		FS_FCloseFile( s_backgroundFile );
-		s_backgroundFile = 0;
-		Com_Printf("No data chunk in %s\n", name);
-		return;
-	}
-
-	s_backgroundInfo.samples = len / (s_backgroundInfo.width * s_backgroundInfo.channels);
-
-	s_backgroundSamples = s_backgroundInfo.samples;
+	S_CloseStream( &s_backgroundStream );
 
 	//
-	// start the background streaming
+	// open up a wav file and start streaming it
 	//
-	Sys_BeginStreamedFile( s_backgroundFile, 0x10000 );
+	S_OpenStream( &s_backgroundStream, name );
 }
 
 /*
@@ -1526,11 +1939,11 @@ void S_UpdateBackgroundTrack( void ) {
 	int		bufferSamples;
 	int		fileSamples;
 	byte	raw[30000];		// just enough to fit in a mac stack frame
-	int		fileBytes;
+	int		maxSamples;
 	int		r;
 	static	float	musicVolume = 0.5f;
 
-	if ( !s_backgroundFile ) {
+	if ( !s_backgroundStream.file ) {
 		return;
 	}
 
@@ -1542,56 +1955,63 @@ void S_UpdateBackgroundTrack( void ) {
 		return;
 	}
 
-	// see how many samples should be copied into the raw buffer
-	if ( s_rawend < s_soundtime ) {
-		s_rawend = s_soundtime;
-	}
-
-	while ( s_rawend < s_soundtime + MAX_RAW_SAMPLES ) {
+	while ( 1 ) {
+		// see how many samples should be copied into the raw buffer, the
+		// mixer thread moves s_soundtime so only the bookkeeping is locked
+		S_LockMixer();
+		if ( s_rawend < s_soundtime ) {
+			s_rawend = s_soundtime;
+		}
 		bufferSamples = MAX_RAW_SAMPLES - (s_rawend - s_soundtime);
+		S_UnlockMixer();
+
+		if ( bufferSamples <= 0 ) {
+			break;
+		}
 
 		// decide how much data needs to be read from the file
-		fileSamples = bufferSamples * s_backgroundInfo.rate / dma.speed;
+		fileSamples = bufferSamples * s_backgroundStream.info.rate / dma.speed;
 
 		// don't try and read past the end of the file
-		if ( fileSamples > s_backgroundSamples ) {
-			fileSamples = s_backgroundSamples;
+		if ( fileSamples > s_backgroundStream.samples ) {
+			fileSamples = s_backgroundStream.samples;
 		}
 
 		// our max buffer size
-		fileBytes = fileSamples * (s_backgroundInfo.width * s_backgroundInfo.channels);
-		if ( fileBytes > sizeof(raw) ) {
-			fileBytes = sizeof(raw);
-			fileSamples = fileBytes / (s_backgroundInfo.width * s_backgroundInfo.channels);
+		maxSamples = sizeof(raw) / (s_backgroundStream.info.width * s_backgroundStream.info.channels);
+		if ( fileSamples > maxSamples ) {
+			fileSamples = maxSamples;
 		}
 
-		r = Sys_StreamedRead( raw, 1, fileBytes, s_backgroundFile );
-		if ( r != fileBytes ) {
+		if ( fileSamples <= 0 ) {
+			break;		// less than one file sample of room left
+		}
+
+		// the stream thread has normally read this far ahead already
+		r = S_ReadStream( &s_backgroundStream, raw, fileSamples );
+		if ( r != fileSamples ) {
 			Com_Printf("StreamedRead failure on music track\n");
 			S_StopBackgroundTrack();
 			return;
 		}
 
 		// byte swap if needed
-		S_ByteSwapRawSamples( fileSamples, s_backgroundInfo.width, s_backgroundInfo.channels, raw );
+		S_ByteSwapRawSamples( fileSamples, s_backgroundStream.info.width, s_backgroundStream.info.channels, raw );
 
 		// add to raw buffer
-		S_RawSamples( fileSamples, s_backgroundInfo.rate, 
-			s_backgroundInfo.width, s_backgroundInfo.channels, raw, musicVolume );
+		S_RawSamples( fileSamples, s_backgroundStream.info.rate, 
+			s_backgroundStream.info.width, s_backgroundStream.info.channels, raw, musicVolume );
+
+		if ( !s_backgroundStream.samples ) {
+			S_CloseStream( &s_backgroundStream );
 
-		s_backgroundSamples -= fileSamples;
-		if ( !s_backgroundSamples ) {
 			// loop
 			if (s_backgroundLoop[0]) {
-				Sys_EndStreamedFile( s_backgroundFile );
-				FS_FCloseFile( s_backgroundFile );
-				s_backgroundFile = 0;
 				S_StartBackgroundTrack( s_backgroundLoop, s_backgroundLoop );
-				if ( !s_backgroundFile ) {
+				if ( !s_backgroundStream.file ) {
 					return;		// loop failed to restart
 				}
 			} else {
-				s_backgroundFile = 0;
 				return;
 			}
 		}
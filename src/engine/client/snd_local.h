@@ -137,6 +137,17 @@ void	SNDDMA_BeginPainting (void);
 
 void	SNDDMA_Submit(void);
 
+// runs mixFunc over and over on its own thread, holding the mixer lock
+qboolean SNDDMA_BeginMixThread( void (*mixFunc)( void ) );
+void	SNDDMA_EndMixThread( void );
+
+// qtrue when the mixer thread hit a device error, the caller shuts down
+qboolean SNDDMA_DeviceLost( void );
+
+// recursive, and a no-op without a mixer thread
+void	SNDDMA_LockMixer( void );
+void	SNDDMA_UnlockMixer( void );
+
 //====================================================================
 
 #define	MAX_CHANNELS			96
@@ -171,6 +182,7 @@ sndBuffer*	SND_malloc();
 void		SND_setup();
 
 void S_PaintChannels(int endtime);
+void S_MixBench_f( void );
 
 void S_memoryLoad(sfx_t *sfx);
 portable_samplepair_t *S_GetRawSamplePointer();
@@ -22,6 +22,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 // snd_mix.c -- portable code to mix sounds for snd_dma.c
 
 #include "snd_local.h"
+#include <emmintrin.h> // SSE2 is always available on x64
 
 static portable_samplepair_t paintbuffer[PAINTBUFFER_SIZE];
 static int snd_vol;
@@ -39,7 +40,15 @@ void S_WriteLinearBlastStereo16 (void)
 	int		i;
 	int		val;
 
-	for (i=0 ; i<snd_linear_count ; i+=2)
+	// the saturating pack does the same clamping as the loop below
+	for (i=0 ; i+8<=snd_linear_count ; i+=8)
+	{
+		__m128i a = _mm_srai_epi32( _mm_loadu_si128( (const __m128i *)( snd_p + i ) ), 8 );
+		__m128i b = _mm_srai_epi32( _mm_loadu_si128( (const __m128i *)( snd_p + i + 4 ) ), 8 );
+		_mm_storeu_si128( (__m128i *)( snd_out + i ), _mm_packs_epi32( a, b ) );
+	}
+
+	for ( ; i<snd_linear_count ; i+=2)
 	{
 		val = snd_p[i]>>8;
 		if (val > 0x7fff)
@@ -223,8 +232,52 @@ CHANNEL MIXING
 ===============================================================================
 */
 
+/*
+===================
+S_MixMono16
+
+Adds count mono samples into the paint buffer, scaled separately for
+the left and right channel
+===================
+*/
+static void S_MixMono16( portable_samplepair_t *samp, const short *samples, int count, int leftvol, int rightvol ) {
+	int		i, data;
+
+	i = 0;
+	if ( leftvol >= 0 && leftvol <= 0xfffe && rightvol >= 0 && rightvol <= 0xfffe ) {
+		// the volumes don't fit a 16 bit multiply, so each is split in two
+		// halves and madd sums both products into a full 32 bit result
+		const __m128i vol = _mm_setr_epi16(
+			(short)(leftvol>>1), (short)(leftvol-(leftvol>>1)), (short)(rightvol>>1), (short)(rightvol-(rightvol>>1)),
+			(short)(leftvol>>1), (short)(leftvol-(leftvol>>1)), (short)(rightvol>>1), (short)(rightvol-(rightvol>>1)) );
+
+		for ( ; i+8<=count ; i+=8 ) {
+			__m128i s = _mm_loadu_si128( (const __m128i *)( samples + i ) );
+			__m128i lo = _mm_unpacklo_epi16( s, s );
+			__m128i hi = _mm_unpackhi_epi16( s, s );
+			__m128i *out = (__m128i *)( samp + i );
+
+			// each sample repeated four times gives left, right pairs
+			_mm_storeu_si128( out, _mm_add_epi32( _mm_loadu_si128( out ),
+				_mm_srai_epi32( _mm_madd_epi16( _mm_unpacklo_epi32( lo, lo ), vol ), 8 ) ) );
+			_mm_storeu_si128( out+1, _mm_add_epi32( _mm_loadu_si128( out+1 ),
+				_mm_srai_epi32( _mm_madd_epi16( _mm_unpackhi_epi32( lo, lo ), vol ), 8 ) ) );
+			_mm_storeu_si128( out+2, _mm_add_epi32( _mm_loadu_si128( out+2 ),
+				_mm_srai_epi32( _mm_madd_epi16( _mm_unpacklo_epi32( hi, hi ), vol ), 8 ) ) );
+			_mm_storeu_si128( out+3, _mm_add_epi32( _mm_loadu_si128( out+3 ),
+				_mm_srai_epi32( _mm_madd_epi16( _mm_unpackhi_epi32( hi, hi ), vol ), 8 ) ) );
+		}
+	}
+
+	for ( ; i<count ; i++ ) {
+		data  = samples[i];
+		samp[i].left += (data * leftvol)>>8;
+		samp[i].right += (data * rightvol)>>8;
+	}
+}
+
 static void S_PaintChannelFrom16( channel_t *ch, const sfx_t *sc, int count, int sampleOffset, int bufferOffset ) {
-	int						data, aoff, boff;
+	int						aoff, boff;
 	int						leftvol, rightvol;
 	int						i, j;
 	portable_samplepair_t	*samp;
@@ -249,6 +302,7 @@ static void S_PaintChannelFrom16( channel_t *ch, const sfx_t *sc, int count, int
 
 	if (!ch->doppler || ch->dopplerScale==1.0f) {
 #if idppc_altivec
+		int data;
 		vector signed short volume_vec;
 		vector unsigned int volume_shift;
 		int vectorCount, samplesLeft, chunkSamplesLeft;
@@ -365,10 +419,14 @@ static void S_PaintChannelFrom16( channel_t *ch, const sfx_t *sc, int count, int
 			}
 		}
 #else			
-		for ( i=0 ; i<count ; i++ ) {
-			data  = samples[sampleOffset++];
-			samp[i].left += (data * leftvol)>>8;
-			samp[i].right += (data * rightvol)>>8;
+		for ( i=0 ; i<count ; i+=j ) {
+			// mix up to the end of the current chunk at once
+			j = SND_CHUNK_SIZE - sampleOffset;
+			if ( j > count - i ) {
+				j = count - i;
+			}
+			S_MixMono16( samp + i, samples + sampleOffset, j, leftvol, rightvol );
+			sampleOffset += j;
 
 			if (sampleOffset == SND_CHUNK_SIZE) {
 				chunk = chunk->next;
@@ -412,9 +470,8 @@ static void S_PaintChannelFrom16( channel_t *ch, const sfx_t *sc, int count, int
 }
 
 void S_PaintChannelFromWavelet( channel_t *ch, sfx_t *sc, int count, int sampleOffset, int bufferOffset ) {
-	int						data;
 	int						leftvol, rightvol;
-	int						i;
+	int						i, n;
 	portable_samplepair_t	*samp;
 	sndBuffer				*chunk;
 	short					*samples;
@@ -439,10 +496,13 @@ void S_PaintChannelFromWavelet( channel_t *ch, sfx_t *sc, int count, int sampleO
 
 	samples = sfxScratchBuffer;
 
-	for ( i=0 ; i<count ; i++ ) {
-		data  = samples[sampleOffset++];
-		samp[i].left += (data * leftvol)>>8;
-		samp[i].right += (data * rightvol)>>8;
+	for ( i=0 ; i<count ; i+=n ) {
+		n = SND_CHUNK_SIZE*2 - sampleOffset;
+		if ( n > count - i ) {
+			n = count - i;
+		}
+		S_MixMono16( samp + i, samples + sampleOffset, n, leftvol, rightvol );
+		sampleOffset += n;
 
 		if (sampleOffset == SND_CHUNK_SIZE*2) {
 			chunk = chunk->next;
@@ -454,9 +514,8 @@ void S_PaintChannelFromWavelet( channel_t *ch, sfx_t *sc, int count, int sampleO
 }
 
 void S_PaintChannelFromADPCM( channel_t *ch, sfx_t *sc, int count, int sampleOffset, int bufferOffset ) {
-	int						data;
 	int						leftvol, rightvol;
-	int						i;
+	int						i, n;
 	portable_samplepair_t	*samp;
 	sndBuffer				*chunk;
 	short					*samples;
@@ -486,10 +545,13 @@ void S_PaintChannelFromADPCM( channel_t *ch, sfx_t *sc, int count, int sampleOff
 
 	samples = sfxScratchBuffer;
 
-	for ( i=0 ; i<count ; i++ ) {
-		data  = samples[sampleOffset++];
-		samp[i].left += (data * leftvol)>>8;
-		samp[i].right += (data * rightvol)>>8;
+	for ( i=0 ; i<count ; i+=n ) {
+		n = SND_CHUNK_SIZE*4 - sampleOffset;
+		if ( n > count - i ) {
+			n = count - i;
+		}
+		S_MixMono16( samp + i, samples + sampleOffset, n, leftvol, rightvol );
+		sampleOffset += n;
 
 		if (sampleOffset == SND_CHUNK_SIZE*4) {
 			chunk = chunk->next;
@@ -503,7 +565,7 @@ void S_PaintChannelFromADPCM( channel_t *ch, sfx_t *sc, int count, int sampleOff
 void S_PaintChannelFromMuLaw( channel_t *ch, sfx_t *sc, int count, int sampleOffset, int bufferOffset ) {
 	int						data;
 	int						leftvol, rightvol;
-	int						i;
+	int						i, j, n;
 	portable_samplepair_t	*samp;
 	sndBuffer				*chunk;
 	byte					*samples;
@@ -523,12 +585,20 @@ void S_PaintChannelFromMuLaw( channel_t *ch, sfx_t *sc, int count, int sampleOff
 	}
 
 	if (!ch->doppler) {
+		short	decoded[SND_CHUNK_SIZE*2];
+
 		samples = (byte *)chunk->sndChunk + sampleOffset;
-		for ( i=0 ; i<count ; i++ ) {
-			data  = mulawToShort[*samples];
-			samp[i].left += (data * leftvol)>>8;
-			samp[i].right += (data * rightvol)>>8;
-			samples++;
+		for ( i=0 ; i<count ; i+=n ) {
+			// expand up to the end of the current chunk, then mix it at once
+			n = (int)((byte *)chunk->sndChunk + SND_CHUNK_SIZE*2 - samples);
+			if ( n > count - i ) {
+				n = count - i;
+			}
+			for ( j=0 ; j<n ; j++ ) {
+				decoded[j] = mulawToShort[samples[j]];
+			}
+			S_MixMono16( samp + i, decoded, n, leftvol, rightvol );
+			samples += n;
 			if (samples == (byte *)chunk->sndChunk+(SND_CHUNK_SIZE*2)) {
 				chunk = chunk->next;
 				samples = (byte *)chunk->sndChunk;
@@ -679,3 +749,82 @@ void S_PaintChannels( int endtime ) {
 		s_paintedtime = end;
 	}
 }
+
+/*
+===================
+S_MixBench_f
+
+Mixes a number of synthetic 16 bit channels into the paint buffer and
+converts it to the output format, without touching the sound device.
+Playing sound stalls while it runs
+===================
+*/
+void S_MixBench_f( void ) {
+	static sndBuffer	chunks[4];
+	static short		out[PAINTBUFFER_SIZE*2];
+	sfx_t				sfx;
+	channel_t			ch;
+	int					numChannels, passes;
+	int					i, j, start, mixMsec, transferMsec;
+	int					oldVol;
+
+	numChannels = 32;
+	if ( Cmd_Argc() > 1 ) {
+		numChannels = atoi( Cmd_Argv( 1 ) );
+	}
+	if ( numChannels < 1 ) {
+		Com_Printf( "usage: s_mixbench [channels]\n" );
+		return;
+	}
+	passes = 100;
+
+	for ( i = 0 ; i < 4 ; i++ ) {
+		for ( j = 0 ; j < SND_CHUNK_SIZE ; j++ ) {
+			chunks[i].sndChunk[j] = (short)( rand() - RAND_MAX / 2 );
+		}
+		chunks[i].next = &chunks[(i + 1) & 3];
+	}
+
+	Com_Memset( &sfx, 0, sizeof( sfx ) );
+	sfx.soundData = chunks;
+	sfx.soundLength = 4 * SND_CHUNK_SIZE;
+
+	Com_Memset( &ch, 0, sizeof( ch ) );
+	ch.thesfx = &sfx;
+	ch.leftvol = 200;
+	ch.rightvol = 100;
+
+	// the paint buffer and the transfer state belong to the mixer thread,
+	// so it waits out the benchmark
+	SNDDMA_LockMixer();
+
+	oldVol = snd_vol;
+	snd_vol = 255;
+
+	start = Sys_Milliseconds();
+	for ( i = 0 ; i < passes ; i++ ) {
+		Com_Memset( paintbuffer, 0, sizeof( paintbuffer ) );
+		for ( j = 0 ; j < numChannels ; j++ ) {
+			S_PaintChannelFrom16( &ch, &sfx, PAINTBUFFER_SIZE, ( j * 331 ) % sfx.soundLength, 0 );
+		}
+	}
+	mixMsec = Sys_Milliseconds() - start;
+
+	start = Sys_Milliseconds();
+	for ( i = 0 ; i < passes ; i++ ) {
+		snd_p = (int *)paintbuffer;
+		snd_out = out;
+		snd_linear_count = PAINTBUFFER_SIZE * 2;
+		S_WriteLinearBlastStereo16();
+	}
+	transferMsec = Sys_Milliseconds() - start;
+
+	snd_vol = oldVol;
+
+	SNDDMA_UnlockMixer();
+
+	Com_Printf( "%i channels, %i samples each\n", numChannels, passes * PAINTBUFFER_SIZE );
+	Com_Printf( "mix:      %5i msec, %.3f usec per channel per 1000 samples\n", mixMsec,
+		mixMsec * 1000.0 / numChannels / ( passes * PAINTBUFFER_SIZE / 1000.0 ) );
+	Com_Printf( "transfer: %5i msec\n", transferMsec );
+}
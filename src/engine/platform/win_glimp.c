@@ -34,6 +34,9 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 ** vk_imp_init
 ** vk_imp_shutdown
 ** vk_imp_create_surface
+**
+** null_imp_init
+** null_imp_shutdown
 */
 #include "../renderer/tr_local.h"
 #include "resource.h"
@@ -971,6 +974,29 @@ void dx_imp_shutdown() {
 	}
 }
 
+void null_imp_init() {
+	ri.Printf(PRINT_ALL, "Initializing null rendering subsystem\n");
+
+	// All qgl calls become no-ops, so the front-end and the tessellation
+	// code run as usual while nothing is submitted to a device.
+	QGL_Init(nullptr);
+	qglActiveTextureARB = [] (GLenum)  {};
+	qglClientActiveTextureARB = [](GLenum) {};
+
+	// No window is created, the mode only defines the virtual screen size.
+	SetMode(r_mode->integer, qfalse);
+	glConfig.maxTextureSize = 2048;
+}
+
+void null_imp_shutdown() {
+	ri.Printf(PRINT_ALL, "Shutting down null rendering subsystem\n");
+
+	QGL_Shutdown();
+
+	memset(&glConfig, 0, sizeof(glConfig));
+	memset(&glState, 0, sizeof(glState));
+}
+
 /*
 ===========================================================
 
@@ -0,0 +1,691 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+// win_httpd.c -- pk3 download server and client
+
+// TransmitFile needs winsock2, which has to come before windows.h
+#include <winsock2.h>
+#include <mswsock.h>
+
+#include "../../game/q_shared.h"
+#include "../qcommon/qcommon.h"
+#include "win_local.h"
+
+/*
+=============================================================================
+
+A minimal HTTP/1.1 responder for clients that download pk3s from sv_dlURL
+instead of through the netchan. One thread accepts connections and each
+connection gets a thread of its own that answers a single GET or HEAD and
+closes. The file goes out with TransmitFile, so its data is never copied
+through user memory.
+
+Only the files the server handed over with Sys_SetDownloadFiles can be
+requested, by exact name, so there is no path for a request to escape the
+game directories. The worker threads never touch the filesystem, cvars or
+the console, all of which belong to the main thread.
+
+=============================================================================
+*/
+
+#define	MAX_HTTP_CONNECTIONS	32
+#define	MAX_HTTP_REQUEST		2048
+#define	HTTP_TIMEOUT			10000		// msec a client gets to send its request
+
+typedef struct {
+	char		name[MAX_QPATH];
+	char		osPath[MAX_OSPATH];
+} httpFile_t;
+
+typedef struct {
+	qboolean			initialized;
+	CRITICAL_SECTION	crit;			// guards the file list
+	httpFile_t			files[MAX_HTTP_FILES];
+	int					numFiles;
+
+	SOCKET				listenSocket;
+	HANDLE				acceptThread;
+	int					port;
+	volatile qboolean	quit;
+	volatile LONG		numConnections;
+} httpServer_t;
+
+static httpServer_t	http;
+
+/*
+===============
+HTTP_Send
+===============
+*/
+static void HTTP_Send( SOCKET s, const char *text ) {
+	send( s, text, (int)strlen( text ), 0 );
+}
+
+/*
+===============
+HTTP_Decode
+
+Undoes the percent escapes in a request path
+===============
+*/
+static void HTTP_Decode( char *s ) {
+	char	*out;
+	int		hi, lo;
+
+	for ( out = s ; *s ; s++ ) {
+		if ( s[0] == '%' && isxdigit( (byte)s[1] ) && isxdigit( (byte)s[2] ) ) {
+			hi = isdigit( (byte)s[1] ) ? s[1] - '0' : ( tolower( (byte)s[1] ) - 'a' + 10 );
+			lo = isdigit( (byte)s[2] ) ? s[2] - '0' : ( tolower( (byte)s[2] ) - 'a' + 10 );
+			*out++ = (char)( hi * 16 + lo );
+			s += 2;
+		} else {
+			*out++ = *s;
+		}
+	}
+	*out = 0;
+}
+
+/*
+===============
+HTTP_FindFile
+===============
+*/
+static qboolean HTTP_FindFile( const char *name, char *osPath, int osPathSize ) {
+	int			i;
+	qboolean	found;
+
+	found = qfalse;
+	EnterCriticalSection( &http.crit );
+	for ( i = 0 ; i < http.numFiles ; i++ ) {
+		if ( !Q_stricmp( http.files[i].name, name ) ) {
+			Q_strncpyz( osPath, http.files[i].osPath, osPathSize );
+			found = qtrue;
+			break;
+		}
+	}
+	LeaveCriticalSection( &http.crit );
+
+	return found;
+}
+
+/*
+===============
+HTTP_ServeConnection
+
+Reads one request and answers it
+===============
+*/
+static void HTTP_ServeConnection( SOCKET s ) {
+	char					request[MAX_HTTP_REQUEST];
+	char					header[512];
+	char					osPath[MAX_OSPATH];
+	char					*path, *end;
+	int						len, ret;
+	int						timeout;
+	qboolean				head;
+	HANDLE					file;
+	LARGE_INTEGER			size;
+	TRANSMIT_FILE_BUFFERS	buffers;
+
+	timeout = HTTP_TIMEOUT;
+	setsockopt( s, SOL_SOCKET, SO_RCVTIMEO, (const char *)&timeout, sizeof( timeout ) );
+	setsockopt( s, SOL_SOCKET, SO_SNDTIMEO, (const char *)&timeout, sizeof( timeout ) );
+
+	// read until the end of the headers, the body of a GET is ignored
+	len = 0;
+	request[0] = 0;
+	while ( !strstr( request, "\r\n\r\n" ) ) {
+		if ( len == sizeof( request ) - 1 ) {
+			HTTP_Send( s, "HTTP/1.1 413 Request Entity Too Large\r\nConnection: close\r\nContent-Length: 0\r\n\r\n" );
+			return;
+		}
+		ret = recv( s, request + len, sizeof( request ) - 1 - len, 0 );
+		if ( ret <= 0 ) {
+			return;
+		}
+		len += ret;
+		request[len] = 0;
+	}
+
+	if ( !strncmp( request, "GET /", 5 ) ) {
+		head = qfalse;
+		path = request + 5;
+	} else if ( !strncmp( request, "HEAD /", 6 ) ) {
+		head = qtrue;
+		path = request + 6;
+	} else {
+		HTTP_Send( s, "HTTP/1.1 501 Not Implemented\r\nConnection: close\r\nContent-Length: 0\r\n\r\n" );
+		return;
+	}
+
+	// cut the path at the protocol version or a query string
+	end = path;
+	while ( *end && *end != ' ' && *end != '?' && *end != '\r' ) {
+		end++;
+	}
+	*end = 0;
+	HTTP_Decode( path );
+
+	file = INVALID_HANDLE_VALUE;
+	if ( HTTP_FindFile( path, osPath, sizeof( osPath ) ) ) {
+		file = CreateFileA( osPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+			FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+	}
+	if ( file == INVALID_HANDLE_VALUE ) {
+		HTTP_Send( s, "HTTP/1.1 404 Not Found\r\nConnection: close\r\nContent-Length: 0\r\n\r\n" );
+		return;
+	}
+
+	if ( !GetFileSizeEx( file, &size ) || size.HighPart ) {
+		CloseHandle( file );
+		HTTP_Send( s, "HTTP/1.1 500 Internal Server Error\r\nConnection: close\r\nContent-Length: 0\r\n\r\n" );
+		return;
+	}
+
+	Com_sprintf( header, sizeof( header ), "HTTP/1.1 200 OK\r\n"
+		"Content-Type: application/octet-stream\r\n"
+		"Content-Length: %u\r\n"
+		"Connection: close\r\n\r\n", (unsigned)size.LowPart );
+
+	if ( head ) {
+		HTTP_Send( s, header );
+	} else {
+		// the header and the whole file in one call, straight from the cache
+		Com_Memset( &buffers, 0, sizeof( buffers ) );
+		buffers.Head = header;
+		buffers.HeadLength = (DWORD)strlen( header );
+		TransmitFile( s, file, 0, 0, NULL, &buffers, 0 );
+	}
+
+	CloseHandle( file );
+}
+
+/*
+===============
+HTTP_ConnectionThread
+===============
+*/
+static DWORD WINAPI HTTP_ConnectionThread( LPVOID param ) {
+	SOCKET	s;
+
+	s = (SOCKET)param;
+	HTTP_ServeConnection( s );
+	shutdown( s, SD_SEND );
+	closesocket( s );
+
+	InterlockedDecrement( &http.numConnections );
+	return 0;
+}
+
+/*
+===============
+HTTP_AcceptThread
+===============
+*/
+static DWORD WINAPI HTTP_AcceptThread( LPVOID param ) {
+	fd_set			set;
+	struct timeval	tv;
+	SOCKET			s;
+	HANDLE			thread;
+
+	while ( !http.quit ) {
+		// wake up now and then to see if we are being shut down
+		FD_ZERO( &set );
+		FD_SET( http.listenSocket, &set );
+		tv.tv_sec = 0;
+		tv.tv_usec = 100000;
+		if ( select( 0, &set, NULL, NULL, &tv ) <= 0 ) {
+			continue;
+		}
+
+		s = accept( http.listenSocket, NULL, NULL );
+		if ( s == INVALID_SOCKET ) {
+			continue;
+		}
+
+		if ( http.numConnections >= MAX_HTTP_CONNECTIONS ) {
+			HTTP_Send( s, "HTTP/1.1 503 Service Unavailable\r\nConnection: close\r\nContent-Length: 0\r\n\r\n" );
+			closesocket( s );
+			continue;
+		}
+
+		InterlockedIncrement( &http.numConnections );
+		thread = CreateThread( NULL, 0, HTTP_ConnectionThread, (LPVOID)s, 0, NULL );
+		if ( !thread ) {
+			InterlockedDecrement( &http.numConnections );
+			closesocket( s );
+			continue;
+		}
+		CloseHandle( thread );
+	}
+
+	return 0;
+}
+
+/*
+===============
+Sys_StartDownloadServer
+===============
+*/
+void Sys_StartDownloadServer( int port ) {
+	struct sockaddr_in	address;
+
+	if ( !http.initialized ) {
+		InitializeCriticalSection( &http.crit );
+		http.initialized = qtrue;
+	}
+
+	if ( http.acceptThread ) {
+		if ( http.port == port ) {
+			return;
+		}
+		Sys_StopDownloadServer();
+	}
+
+	http.listenSocket = socket( AF_INET, SOCK_STREAM, IPPROTO_TCP );
+	if ( http.listenSocket == INVALID_SOCKET ) {
+		Com_Printf( "WARNING: Sys_StartDownloadServer: socket: %s\n", NET_ErrorString() );
+		return;
+	}
+
+	Com_Memset( &address, 0, sizeof( address ) );
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = INADDR_ANY;
+	address.sin_port = htons( (u_short)port );
+
+	if ( bind( http.listenSocket, (struct sockaddr *)&address, sizeof( address ) ) == SOCKET_ERROR
+		|| listen( http.listenSocket, SOMAXCONN ) == SOCKET_ERROR ) {
+		Com_Printf( "WARNING: Sys_StartDownloadServer: port %i: %s\n", port, NET_ErrorString() );
+		closesocket( http.listenSocket );
+		return;
+	}
+
+	http.quit = qfalse;
+	http.port = port;
+	http.acceptThread = CreateThread( NULL, 0, HTTP_AcceptThread, NULL, 0, NULL );
+	if ( !http.acceptThread ) {
+		closesocket( http.listenSocket );
+		return;
+	}
+
+	Com_Printf( "HTTP download server on TCP port %i\n", port );
+}
+
+/*
+===============
+Sys_StopDownloadServer
+
+Transfers that are already running finish on their own threads
+===============
+*/
+void Sys_StopDownloadServer( void ) {
+	if ( !http.acceptThread ) {
+		return;
+	}
+
+	http.quit = qtrue;
+	WaitForSingleObject( http.acceptThread, INFINITE );
+	CloseHandle( http.acceptThread );
+	http.acceptThread = NULL;
+	closesocket( http.listenSocket );
+
+	Sys_SetDownloadFiles( 0, NULL, NULL );
+}
+
+/*
+===============
+Sys_SetDownloadFiles
+===============
+*/
+void Sys_SetDownloadFiles( int numFiles, const char **names, const char **osPaths ) {
+	int		i;
+
+	if ( !http.initialized ) {
+		return;
+	}
+
+	if ( numFiles > MAX_HTTP_FILES ) {
+		numFiles = MAX_HTTP_FILES;
+	}
+
+	EnterCriticalSection( &http.crit );
+	for ( i = 0 ; i < numFiles ; i++ ) {
+		Q_strncpyz( http.files[i].name, names[i], sizeof( http.files[i].name ) );
+		Q_strncpyz( http.files[i].osPath, osPaths[i], sizeof( http.files[i].osPath ) );
+	}
+	http.numFiles = numFiles;
+	LeaveCriticalSection( &http.crit );
+}
+
+
+/*
+=============================================================================
+
+DOWNLOAD CLIENT
+
+The client side of sv_dlURL. One GET runs at a time on its own thread,
+straight into a file below the home path that the main thread has already
+created. Like the server threads it never touches the filesystem, cvars
+or the console; the main thread resolves the host before the thread
+starts and reads the progress from the volatile counters.
+
+=============================================================================
+*/
+
+#define	HTTP_BLOCK_SIZE		0x4000
+
+typedef struct {
+	HANDLE				thread;
+	SOCKET				socket;
+	struct sockaddr_in	address;
+	char				request[MAX_HTTP_REQUEST];
+	char				osPath[MAX_OSPATH];
+
+	volatile LONG		count;
+	volatile LONG		size;			// -1 until the headers are in, or without a Content-Length
+	volatile LONG		status;			// httpDownloadStatus_t
+	volatile qboolean	abort;
+} httpDownload_t;
+
+static httpDownload_t	httpdl;
+
+/*
+===============
+HTTP_Connect
+
+Connects without blocking, so Sys_EndHTTPDownload doesn't have to wait
+out a host that never answers
+===============
+*/
+static qboolean HTTP_Connect( SOCKET s, const struct sockaddr_in *address ) {
+	fd_set			writeSet, errorSet;
+	struct timeval	tv;
+	u_long			nonBlocking;
+	int				waited;
+
+	nonBlocking = 1;
+	ioctlsocket( s, FIONBIO, &nonBlocking );
+
+	if ( connect( s, (const struct sockaddr *)address, sizeof( *address ) ) == SOCKET_ERROR
+		&& WSAGetLastError() != WSAEWOULDBLOCK ) {
+		return qfalse;
+	}
+
+	for ( waited = 0 ; ; waited += 100 ) {
+		if ( httpdl.abort || waited >= HTTP_TIMEOUT ) {
+			return qfalse;
+		}
+		FD_ZERO( &writeSet );
+		FD_ZERO( &errorSet );
+		FD_SET( s, &writeSet );
+		FD_SET( s, &errorSet );
+		tv.tv_sec = 0;
+		tv.tv_usec = 100000;
+		if ( select( 0, NULL, &writeSet, &errorSet, &tv ) > 0 ) {
+			if ( FD_ISSET( s, &errorSet ) ) {
+				return qfalse;
+			}
+			break;
+		}
+	}
+
+	nonBlocking = 0;
+	ioctlsocket( s, FIONBIO, &nonBlocking );
+	return qtrue;
+}
+
+/*
+===============
+HTTP_ParseHeaders
+
+Returns the Content-Length of a 200 response, -1 if it has none, or -2
+for anything else
+===============
+*/
+static int HTTP_ParseHeaders( const char *headers ) {
+	const char	*line;
+
+	if ( Q_stricmpn( headers, "HTTP/1.", 7 ) || !headers[7] || strncmp( headers + 8, " 200", 4 ) ) {
+		return -2;
+	}
+
+	for ( line = strstr( headers, "\r\n" ) ; line ; line = strstr( line, "\r\n" ) ) {
+		line += 2;
+		if ( !Q_stricmpn( line, "Content-Length:", 15 ) ) {
+			return atoi( line + 15 );
+		}
+	}
+
+	return -1;
+}
+
+/*
+===============
+HTTP_Download
+
+Runs the whole transfer, returns qtrue if every byte arrived
+===============
+*/
+static qboolean HTTP_Download( void ) {
+	char	buffer[HTTP_BLOCK_SIZE + 1];
+	char	*body;
+	int		len, ret;
+	int		timeout;
+	int		size;
+	DWORD	written;
+	HANDLE	file;
+
+	if ( !HTTP_Connect( httpdl.socket, &httpdl.address ) ) {
+		return qfalse;
+	}
+
+	timeout = HTTP_TIMEOUT;
+	setsockopt( httpdl.socket, SOL_SOCKET, SO_RCVTIMEO, (const char *)&timeout, sizeof( timeout ) );
+	setsockopt( httpdl.socket, SOL_SOCKET, SO_SNDTIMEO, (const char *)&timeout, sizeof( timeout ) );
+
+	len = (int)strlen( httpdl.request );
+	if ( send( httpdl.socket, httpdl.request, len, 0 ) != len ) {
+		return qfalse;
+	}
+
+	// read the headers, the first block of the body may come with them
+	len = 0;
+	buffer[0] = 0;
+	while ( ( body = strstr( buffer, "\r\n\r\n" ) ) == NULL ) {
+		if ( len == HTTP_BLOCK_SIZE ) {
+			return qfalse;
+		}
+		ret = recv( httpdl.socket, buffer + len, HTTP_BLOCK_SIZE - len, 0 );
+		if ( ret <= 0 || httpdl.abort ) {
+			return qfalse;
+		}
+		len += ret;
+		buffer[len] = 0;
+	}
+	body += 4;
+
+	size = HTTP_ParseHeaders( buffer );
+	if ( size == -2 ) {
+		return qfalse;
+	}
+	httpdl.size = size;
+
+	file = CreateFileA( httpdl.osPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+	if ( file == INVALID_HANDLE_VALUE ) {
+		return qfalse;
+	}
+
+	len -= (int)( body - buffer );
+	while ( 1 ) {
+		if ( len > 0 ) {
+			if ( !WriteFile( file, body, len, &written, NULL ) || (int)written != len ) {
+				len = -1;
+				break;
+			}
+			// volatile store, only this thread writes it
+			httpdl.count += len;
+		}
+
+		if ( httpdl.abort || ( size >= 0 && httpdl.count >= size ) ) {
+			break;
+		}
+		len = recv( httpdl.socket, buffer, HTTP_BLOCK_SIZE, 0 );
+		if ( len <= 0 ) {
+			break;
+		}
+		body = buffer;
+	}
+
+	CloseHandle( file );
+
+	if ( httpdl.abort || len < 0 ) {
+		return qfalse;
+	}
+	if ( size >= 0 ) {
+		return httpdl.count == size ? qtrue : qfalse;
+	}
+	return qtrue;		// no length, so the server closing is the end
+}
+
+/*
+===============
+HTTP_DownloadThread
+===============
+*/
+static DWORD WINAPI HTTP_DownloadThread( LPVOID param ) {
+	// volatile store, the main thread ends the download once it sees it
+	httpdl.status = HTTP_Download() ? HTTPDL_DONE : HTTPDL_FAILED;
+	return 0;
+}
+
+/*
+===============
+Sys_BeginHTTPDownload
+
+Only http:// urls, the host is resolved here on the main thread
+===============
+*/
+qboolean Sys_BeginHTTPDownload( const char *url, const char *osPath ) {
+	char		host[MAX_QPATH];
+	const char	*path, *port;
+	netadr_t	adr;
+	int			len;
+
+	Sys_EndHTTPDownload();
+
+	if ( Q_stricmpn( url, "http://", 7 ) ) {
+		Com_Printf( "Sys_BeginHTTPDownload: only http:// is supported: %s\n", url );
+		return qfalse;
+	}
+	url += 7;
+
+	path = strchr( url, '/' );
+	if ( !path ) {
+		path = url + strlen( url );
+	}
+	len = (int)( path - url );
+	if ( len <= 0 || len >= (int)sizeof( host ) ) {
+		Com_Printf( "Sys_BeginHTTPDownload: bad host in %s\n", url );
+		return qfalse;
+	}
+	Q_strncpyz( host, url, len + 1 );
+
+	port = strchr( host, ':' );
+	if ( port ) {
+		host[port - host] = 0;
+		port++;
+	}
+
+	if ( !Sys_StringToAdr( host, &adr ) ) {
+		Com_Printf( "Sys_BeginHTTPDownload: couldn't resolve %s\n", host );
+		return qfalse;
+	}
+
+	Com_Memset( &httpdl.address, 0, sizeof( httpdl.address ) );
+	httpdl.address.sin_family = AF_INET;
+	Com_Memcpy( &httpdl.address.sin_addr, adr.ip, 4 );
+	httpdl.address.sin_port = htons( (u_short)( port ? atoi( port ) : 80 ) );
+
+	// the Host header keeps the port, so restore it
+	if ( port ) {
+		host[port - 1 - host] = ':';
+	}
+	Com_sprintf( httpdl.request, sizeof( httpdl.request ), "GET %s HTTP/1.1\r\n"
+		"Host: %s\r\n"
+		"User-Agent: " Q3_VERSION "\r\n"
+		"Connection: close\r\n\r\n", path[0] ? path : "/", host );
+	Q_strncpyz( httpdl.osPath, osPath, sizeof( httpdl.osPath ) );
+
+	httpdl.socket = socket( AF_INET, SOCK_STREAM, IPPROTO_TCP );
+	if ( httpdl.socket == INVALID_SOCKET ) {
+		Com_Printf( "Sys_BeginHTTPDownload: socket: %s\n", NET_ErrorString() );
+		return qfalse;
+	}
+
+	httpdl.count = 0;
+	httpdl.size = -1;
+	httpdl.abort = qfalse;
+	httpdl.status = HTTPDL_RUNNING;
+
+	httpdl.thread = CreateThread( NULL, 0, HTTP_DownloadThread, NULL, 0, NULL );
+	if ( !httpdl.thread ) {
+		closesocket( httpdl.socket );
+		httpdl.status = HTTPDL_IDLE;
+		return qfalse;
+	}
+
+	return qtrue;
+}
+
+/*
+===============
+Sys_HTTPDownloadStatus
+===============
+*/
+httpDownloadStatus_t Sys_HTTPDownloadStatus( int *count, int *size ) {
+	*count = httpdl.count;
+	*size = httpdl.size;
+	return (httpDownloadStatus_t)httpdl.status;
+}
+
+/*
+===============
+Sys_EndHTTPDownload
+
+Stops a running transfer, the partial file is left behind
+===============
+*/
+void Sys_EndHTTPDownload( void ) {
+	if ( !httpdl.thread ) {
+		return;
+	}
+
+	// wakes a blocked recv, the connect polls the flag
+	httpdl.abort = qtrue;
+	shutdown( httpdl.socket, SD_BOTH );
+
+	WaitForSingleObject( httpdl.thread, INFINITE );
+	CloseHandle( httpdl.thread );
+	closesocket( httpdl.socket );
+	httpdl.thread = NULL;
+	httpdl.status = HTTPDL_IDLE;
+}
@@ -49,6 +49,10 @@ char	*Sys_ConsoleInput (void);
 
 qboolean	Sys_GetPacket ( netadr_t *net_from, msg_t *net_message );
 
+char	*NET_ErrorString( void );
+void	NET_LoadTest_f( void );
+void	NET_LoadTestFrame( void );
+
 // Input subsystem
 
 void	IN_Init (void);
@@ -627,90 +627,100 @@ BACKGROUND FILE STREAMING
 ========================================================================
 */
 
-#if 1
-
-void Sys_InitStreamThread( void ) {
-}
-
-void Sys_ShutdownStreamThread( void ) {
-}
-
-void Sys_BeginStreamedFile( fileHandle_t f, int readAhead ) {
-}
-
-void Sys_EndStreamedFile( fileHandle_t f ) {
-}
-
-int Sys_StreamedRead( void *buffer, int size, int count, fileHandle_t f ) {
-   return FS_Read( buffer, size * count, f );
-}
-
-void Sys_StreamSeek( fileHandle_t f, int offset, int origin ) {
-   FS_Seek( f, offset, origin );
-}
-
-
-#else
+/*
+One thread reads ahead on every streamed file, so music and cinematics
+never wait on the disk in the main loop. The reader only ever fills the
+part of a buffer that Sys_StreamedRead has already consumed, and each
+position is only written by one side, so the copy out needs no lock.
+The critical section keeps a buffer from being freed or rewound while
+the thread is reading into it.
+
+Only the thread may touch a file between Sys_BeginStreamedFile and
+Sys_EndStreamedFile, so it must have been opened unique if it is in a pak.
+The thread reads with FS_ReadFromThread, which never errors out, and a
+unique pk3 file inflates with malloc instead of the zone.
+*/
 
 typedef struct {
 	fileHandle_t	file;
-	byte	*buffer;
-	qboolean	eof;
-	qboolean	active;
-	int		bufferSize;
-	int		streamPosition;	// next byte to be returned by Sys_StreamRead
-	int		threadPosition;	// next byte to be read from file
+	byte			*buffer;
+	int				bufferSize;
+	volatile qboolean	eof;
+	volatile qboolean	active;
+	volatile int	streamPosition;	// next byte to be returned by Sys_StreamedRead
+	volatile int	threadPosition;	// next byte to be read from file
 } streamsIO_t;
 
 typedef struct {
 	HANDLE				threadHandle;
-	int					threadId;
+	DWORD				threadId;
+	HANDLE				wakeEvent;		// set when a buffer has room again
+	volatile qboolean	quit;
 	CRITICAL_SECTION	crit;
 	streamsIO_t			sIO[MAX_FILE_HANDLES];
 } streamState_t;
 
-streamState_t	stream;
+static streamState_t	stream;
 
 /*
 ===============
-Sys_StreamThread
+Sys_StreamFill
 
-A thread will be sitting in this loop forever
+Reads as far ahead as the buffer allows, called with the critical section held
 ================
 */
-void Sys_StreamThread( void ) {
-	int		buffer;
+static void Sys_StreamFill( streamsIO_t *s ) {
 	int		count;
 	int		readCount;
 	int		bufferPoint;
-	int		r, i;
-
-	while (1) {
-		Sleep( 10 );
-//		EnterCriticalSection (&stream.crit);
-
-		for (i=1;i<MAX_FILE_HANDLES;i++) {
-			// if there is any space left in the buffer, fill it up
-			if ( stream.sIO[i].active  && !stream.sIO[i].eof ) {
-				count = stream.sIO[i].bufferSize - (stream.sIO[i].threadPosition - stream.sIO[i].streamPosition);
-				if ( !count ) {
-					continue;
-				}
+	int		r;
 
-				bufferPoint = stream.sIO[i].threadPosition % stream.sIO[i].bufferSize;
-				buffer = stream.sIO[i].bufferSize - bufferPoint;
-				readCount = buffer < count ? buffer : count;
+	while ( !s->eof ) {
+		count = s->bufferSize - ( s->threadPosition - s->streamPosition );
+		if ( count <= 0 ) {
+			return;
+		}
 
-				r = FS_Read( stream.sIO[i].buffer + bufferPoint, readCount, stream.sIO[i].file );
-				stream.sIO[i].threadPosition += r;
+		bufferPoint = s->threadPosition % s->bufferSize;
+		readCount = s->bufferSize - bufferPoint;
+		if ( readCount > count ) {
+			readCount = count;
+		}
 
-				if ( r != readCount ) {
-					stream.sIO[i].eof = qtrue;
-				}
+		r = FS_ReadFromThread( s->buffer + bufferPoint, readCount, s->file );
+
+		// volatile store, the data is visible before the new position
+		s->threadPosition += r;
+
+		if ( r != readCount ) {
+			s->eof = qtrue;
+		}
+	}
+}
+
+/*
+===============
+Sys_StreamThread
+
+Sleeps until a streamed file has been read from
+================
+*/
+static DWORD WINAPI Sys_StreamThread( LPVOID param ) {
+	int		i;
+
+	while ( !stream.quit ) {
+		WaitForSingleObject( stream.wakeEvent, INFINITE );
+
+		EnterCriticalSection( &stream.crit );
+		for ( i = 1 ; i < MAX_FILE_HANDLES ; i++ ) {
+			if ( stream.sIO[i].active ) {
+				Sys_StreamFill( &stream.sIO[i] );
 			}
 		}
-//		LeaveCriticalSection (&stream.crit);
+		LeaveCriticalSection( &stream.crit );
 	}
+
+	return 0;
 }
 
 /*
@@ -720,24 +730,14 @@ Sys_InitStreamThread
 ================
 */
 void Sys_InitStreamThread( void ) {
-	int i;
-
-	InitializeCriticalSection ( &stream.crit );
-
-	// don't leave the critical section until there is a
-	// valid file to stream, which will cause the StreamThread
-	// to sleep without any overhead
-//	EnterCriticalSection( &stream.crit );
-
-	stream.threadHandle = CreateThread(
-	   NULL,	// LPSECURITY_ATTRIBUTES lpsa,
-	   0,		// DWORD cbStack,
-	   (LPTHREAD_START_ROUTINE)Sys_StreamThread,	// LPTHREAD_START_ROUTINE lpStartAddr,
-	   0,			// LPVOID lpvThreadParm,
-	   0,			//   DWORD fdwCreate,
-	   &stream.threadId);
-	for(i=0;i<MAX_FILE_HANDLES;i++) {
-		stream.sIO[i].active = qfalse;
+	memset( &stream, 0, sizeof( stream ) );
+
+	InitializeCriticalSection( &stream.crit );
+	stream.wakeEvent = CreateEvent( NULL, FALSE, FALSE, NULL );
+
+	stream.threadHandle = CreateThread( NULL, 0, Sys_StreamThread, NULL, 0, &stream.threadId );
+	if ( !stream.threadHandle ) {
+		Com_Printf( "Couldn't create the file streaming thread\n" );
 	}
 }
 
@@ -748,6 +748,17 @@ Sys_ShutdownStreamThread
 ================
 */
 void Sys_ShutdownStreamThread( void ) {
+	if ( !stream.threadHandle ) {
+		return;
+	}
+
+	stream.quit = qtrue;
+	SetEvent( stream.wakeEvent );
+	WaitForSingleObject( stream.threadHandle, INFINITE );
+	CloseHandle( stream.threadHandle );
+	CloseHandle( stream.wakeEvent );
+	DeleteCriticalSection( &stream.crit );
+	stream.threadHandle = NULL;
 }
 
 
@@ -758,41 +769,52 @@ Sys_BeginStreamedFile
 ================
 */
 void Sys_BeginStreamedFile( fileHandle_t f, int readAhead ) {
-	if ( stream.sIO[f].file ) {
-		Sys_EndStreamedFile( stream.sIO[f].file );
+	streamsIO_t	*s;
+
+	if ( !stream.threadHandle ) {
+		return;		// Sys_StreamedRead falls back to FS_Read
 	}
 
-	stream.sIO[f].file = f;
-	stream.sIO[f].buffer = Z_Malloc( readAhead );
-	stream.sIO[f].bufferSize = readAhead;
-	stream.sIO[f].streamPosition = 0;
-	stream.sIO[f].threadPosition = 0;
-	stream.sIO[f].eof = qfalse;
-	stream.sIO[f].active = qtrue;
+	Sys_EndStreamedFile( f );
+
+	s = &stream.sIO[f];
+	s->file = f;
+	s->buffer = Z_Malloc( readAhead );
+	s->bufferSize = readAhead;
+	s->streamPosition = 0;
+	s->threadPosition = 0;
+	s->eof = qfalse;
+
+	EnterCriticalSection( &stream.crit );
+	s->active = qtrue;
+	LeaveCriticalSection( &stream.crit );
 
-	// let the thread start running
-//	LeaveCriticalSection( &stream.crit );
+	SetEvent( stream.wakeEvent );
 }
 
 /*
 ===============
 Sys_EndStreamedFile
 
+Safe to call on a file that isn't streamed
 ================
 */
 void Sys_EndStreamedFile( fileHandle_t f ) {
-	if ( f != stream.sIO[f].file ) {
-		Com_Error( ERR_FATAL, "Sys_EndStreamedFile: wrong file");
-	}
-	// don't leave critical section until another stream is started
-	EnterCriticalSection( &stream.crit );
-
-	stream.sIO[f].file = 0;
-	stream.sIO[f].active = qfalse;
+	streamsIO_t	*s;
 
-	Z_Free( stream.sIO[f].buffer );
+	s = &stream.sIO[f];
+	if ( !s->active ) {
+		return;
+	}
 
+	// waits for the thread to finish any read on this file
+	EnterCriticalSection( &stream.crit );
+	s->active = qfalse;
+	s->file = 0;
 	LeaveCriticalSection( &stream.crit );
+
+	Z_Free( s->buffer );
+	s->buffer = NULL;
 }
 
 
@@ -803,6 +825,7 @@ Sys_StreamedRead
 ================
 */
 int Sys_StreamedRead( void *buffer, int size, int count, fileHandle_t f ) {
+	streamsIO_t	*s;
 	int		available;
 	int		remaining;
 	int		sleepCount;
@@ -811,8 +834,9 @@ int Sys_StreamedRead( void *buffer, int size, int count, fileHandle_t f ) {
 	int		bufferPoint;
 	byte	*dest;
 
-	if (stream.sIO[f].active == qfalse) {
-		Com_Error( ERR_FATAL, "Streamed read with non-streaming file" );
+	s = &stream.sIO[f];
+	if ( !s->active ) {
+		return FS_Read( buffer, size * count, f ) / size;
 	}
 
 	dest = (byte *)buffer;
@@ -824,38 +848,38 @@ int Sys_StreamedRead( void *buffer, int size, int count, fileHandle_t f ) {
 
 	sleepCount = 0;
 	while ( remaining > 0 ) {
-		available = stream.sIO[f].threadPosition - stream.sIO[f].streamPosition;
+		available = s->threadPosition - s->streamPosition;
 		if ( !available ) {
-			if ( stream.sIO[f].eof ) {
+			if ( s->eof ) {
 				break;
 			}
 			if ( sleepCount == 1 ) {
 				Com_DPrintf( "Sys_StreamedRead: waiting\n" );
 			}
-			if ( ++sleepCount > 100 ) {
-				Com_Error( ERR_FATAL, "Sys_StreamedRead: thread has died");
+			if ( ++sleepCount > 1000 ) {
+				Com_Error( ERR_FATAL, "Sys_StreamedRead: thread has died" );
 			}
-			Sleep( 10 );
+			SetEvent( stream.wakeEvent );
+			Sleep( 1 );
 			continue;
 		}
 
-		EnterCriticalSection( &stream.crit );
-
-		bufferPoint = stream.sIO[f].streamPosition % stream.sIO[f].bufferSize;
-		bufferCount = stream.sIO[f].bufferSize - bufferPoint;
+		bufferPoint = s->streamPosition % s->bufferSize;
+		bufferCount = s->bufferSize - bufferPoint;
 
 		copy = available < bufferCount ? available : bufferCount;
 		if ( copy > remaining ) {
 			copy = remaining;
 		}
-		memcpy( dest, stream.sIO[f].buffer + bufferPoint, copy );
-		stream.sIO[f].streamPosition += copy;
+		memcpy( dest, s->buffer + bufferPoint, copy );
+		s->streamPosition += copy;
 		dest += copy;
 		remaining -= copy;
-
-		LeaveCriticalSection( &stream.crit );
 	}
 
+	// there is room to read ahead again
+	SetEvent( stream.wakeEvent );
+
 	return (count * size - remaining) / size;
 }
 
@@ -866,21 +890,28 @@ Sys_StreamSeek
 ================
 */
 void Sys_StreamSeek( fileHandle_t f, int offset, int origin ) {
+	streamsIO_t	*s;
 
-	// halt the thread
-	EnterCriticalSection( &stream.crit );
+	s = &stream.sIO[f];
+	if ( !s->active ) {
+		FS_Seek( f, offset, origin );
+		return;
+	}
 
-	// clear to that point
+	// the file position is ahead of the reader, so rewind to
+	// where the reader is before applying a relative seek
+	EnterCriticalSection( &stream.crit );
+	if ( origin == FS_SEEK_CUR ) {
+		offset -= s->threadPosition - s->streamPosition;
+	}
 	FS_Seek( f, offset, origin );
-	stream.sIO[f].streamPosition = 0;
-	stream.sIO[f].threadPosition = 0;
-	stream.sIO[f].eof = qfalse;
-
-	// let the thread start running at the new position
+	s->streamPosition = 0;
+	s->threadPosition = 0;
+	s->eof = qfalse;
 	LeaveCriticalSection( &stream.crit );
-}
 
-#endif
+	SetEvent( stream.wakeEvent );
+}
 
 /*
 ========================================================================
@@ -893,8 +924,21 @@ EVENT LOOP
 #define	MAX_QUED_EVENTS		256
 #define	MASK_QUED_EVENTS	( MAX_QUED_EVENTS - 1 )
 
-sysEvent_t	eventQue[MAX_QUED_EVENTS];
-int			eventHead, eventTail;
+// The event queue takes events from any thread without a lock. Producers
+// claim a slot by advancing eventHead and publish it by advancing the
+// slot's sequence, the main thread is the only consumer. Sequences are
+// kept relative to the lap of the queue (pos & ~MASK_QUED_EVENTS), so a
+// zeroed slot is free: lap means free, lap + 1 means holding an event for
+// this lap, and after the read it becomes the next lap.
+typedef struct {
+	volatile LONG	sequence;
+	sysEvent_t		ev;
+} quedEvent_t;
+
+static quedEvent_t		eventQue[MAX_QUED_EVENTS];
+static volatile LONG	eventHead;			// next slot a producer will claim
+static LONG				eventTail;			// next slot the main thread will read
+static volatile LONG	eventsDropped;
 byte		sys_packetReceived[MAX_MSGLEN];
 
 /*
@@ -903,34 +947,73 @@ Sys_QueEvent
 
 A time of 0 will get the current time
 Ptr should either be null, or point to a block of data that can
-be freed by the game later.
+be freed by the game later. The zone is not thread safe, so events
+with a ptr can only be queued by the main thread.
 ================
 */
 void Sys_QueEvent( int time, sysEventType_t type, int value, int value2, int ptrLength, void *ptr ) {
-	sysEvent_t	*ev;
-
-	ev = &eventQue[ eventHead & MASK_QUED_EVENTS ];
-	if ( eventHead - eventTail >= MAX_QUED_EVENTS ) {
-		Com_Printf("Sys_QueEvent: overflow\n");
-		// we are discarding an event, but don't leak memory
-		if ( ev->evPtr ) {
-			Z_Free( ev->evPtr );
+	quedEvent_t	*q;
+	LONG		pos, lap, diff;
+
+	while ( 1 ) {
+		pos = eventHead;
+		q = &eventQue[ pos & MASK_QUED_EVENTS ];
+		lap = pos & ~MASK_QUED_EVENTS;
+		diff = q->sequence - lap;
+		if ( diff == 0 ) {
+			if ( InterlockedCompareExchange( &eventHead, pos + 1, pos ) == pos ) {
+				break;
+			}
+		} else if ( diff < 0 ) {
+			// full, the main thread hasn't read this slot since the last
+			// lap, so drop the new event and let Sys_GetEvent report it
+			InterlockedIncrement( &eventsDropped );
+			if ( ptr ) {
+				Z_Free( ptr );
+			}
+			return;
 		}
-		eventTail++;
+		// another producer got the slot first
 	}
 
-	eventHead++;
-
 	if ( time == 0 ) {
 		time = Sys_Milliseconds();
 	}
 
-	ev->evTime = time;
-	ev->evType = type;
-	ev->evValue = value;
-	ev->evValue2 = value2;
-	ev->evPtrLength = ptrLength;
-	ev->evPtr = ptr;
+	q->ev.evTime = time;
+	q->ev.evType = type;
+	q->ev.evValue = value;
+	q->ev.evValue2 = value2;
+	q->ev.evPtrLength = ptrLength;
+	q->ev.evPtr = ptr;
+	q->ev.evUsec = Sys_Microseconds();
+
+	// publish it
+	InterlockedExchange( &q->sequence, lap + 1 );
+}
+
+/*
+================
+Sys_TakeEvent
+
+Main thread only
+================
+*/
+static qboolean Sys_TakeEvent( sysEvent_t *ev ) {
+	quedEvent_t	*q;
+	LONG		lap;
+
+	q = &eventQue[ eventTail & MASK_QUED_EVENTS ];
+	lap = eventTail & ~MASK_QUED_EVENTS;
+	if ( q->sequence != lap + 1 ) {
+		return qfalse;
+	}
+
+	*ev = q->ev;
+	InterlockedExchange( &q->sequence, lap + MAX_QUED_EVENTS );
+	eventTail++;
+
+	return qtrue;
 }
 
 /*
@@ -945,11 +1028,16 @@ sysEvent_t Sys_GetEvent( void ) {
 	char		*s;
 	msg_t		netmsg;
 	netadr_t	adr;
+	LONG		dropped;
+
+	dropped = InterlockedExchange( &eventsDropped, 0 );
+	if ( dropped ) {
+		Com_Printf( "Sys_QueEvent: overflow, %i events dropped\n", dropped );
+	}
 
 	// return if we have data
-	if ( eventHead > eventTail ) {
-		eventTail++;
-		return eventQue[ ( eventTail - 1 ) & MASK_QUED_EVENTS ];
+	if ( Sys_TakeEvent( &ev ) ) {
+		return ev;
 	}
 
 	// pump the message loop
@@ -977,9 +1065,11 @@ sysEvent_t Sys_GetEvent( void ) {
 		Sys_QueEvent( 0, SE_CONSOLE, 0, 0, len, b );
 	}
 
-	// check for network packets
+	// check for network packets, draining everything that has arrived
+	// instead of going around the message loop again for each one, but
+	// leave room in the queue for the input events
 	MSG_Init( &netmsg, sys_packetReceived, sizeof( sys_packetReceived ) );
-	if ( Sys_GetPacket ( &adr, &netmsg ) ) {
+	while ( eventHead - eventTail < MAX_QUED_EVENTS / 2 && Sys_GetPacket ( &adr, &netmsg ) ) {
 		netadr_t		*buf;
 		int				len;
 
@@ -993,9 +1083,8 @@ sysEvent_t Sys_GetEvent( void ) {
 	}
 
 	// return if we have data
-	if ( eventHead > eventTail ) {
-		eventTail++;
-		return eventQue[ ( eventTail - 1 ) & MASK_QUED_EVENTS ];
+	if ( Sys_TakeEvent( &ev ) ) {
+		return ev;
 	}
 
 	// create an empty event to return
@@ -1053,6 +1142,7 @@ void Sys_Init( void ) {
 
 	Cmd_AddCommand ("in_restart", Sys_In_Restart_f);
 	Cmd_AddCommand ("net_restart", Sys_Net_Restart_f);
+	Cmd_AddCommand ("netload", NET_LoadTest_f);
 
 	g_wv.osversion.dwOSVersionInfoSize = sizeof( g_wv.osversion );
 
@@ -1200,6 +1290,9 @@ int WINAPI WinMain (HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLin
 		// make sure mouse and joystick are only called once a frame
 		IN_Frame();
 
+		// generate fake client traffic if a netload is running
+		NET_LoadTestFrame();
+
 		// run the game
 		Com_Frame();
 
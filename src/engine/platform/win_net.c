@@ -970,6 +970,157 @@ void NET_Config( qboolean enableNetworking ) {
 }
 
 
+/*
+=============================================================================
+
+LOAD GENERATOR
+
+netload <clients> [seconds] [address] opens a socket for each simulated
+client and has every one of them send a getinfo to the server once a
+frame, then reports how many packets a second made it through and back.
+The server side runs the normal Sys_GetPacket / SV_ConnectionlessPacket
+path, so this measures the receive and reply cost per packet.
+
+=============================================================================
+*/
+
+#define	MAX_LOAD_CLIENTS	1024
+
+typedef struct {
+	SOCKET				sockets[MAX_LOAD_CLIENTS];
+	int					numClients;
+	struct sockaddr_in	target;
+	int					startTime;
+	int					endTime;
+	int					sent;
+	int					received;
+} netLoadTest_t;
+
+static netLoadTest_t	loadTest;
+
+/*
+====================
+NET_StopLoadTest
+====================
+*/
+static void NET_StopLoadTest( void ) {
+	int		i;
+	int		msec;
+
+	if ( !loadTest.numClients ) {
+		return;
+	}
+
+	for ( i = 0 ; i < loadTest.numClients ; i++ ) {
+		closesocket( loadTest.sockets[i] );
+	}
+
+	msec = Sys_Milliseconds() - loadTest.startTime;
+	if ( msec < 1 ) {
+		msec = 1;
+	}
+	Com_Printf( "netload: %i clients, %i sent, %i received, %.1f seconds: %i packets/sec\n",
+		loadTest.numClients, loadTest.sent, loadTest.received, msec / 1000.0f,
+		(int)( loadTest.received * 1000.0 / msec ) );
+
+	loadTest.numClients = 0;
+}
+
+/*
+====================
+NET_LoadTest_f
+====================
+*/
+void NET_LoadTest_f( void ) {
+	netadr_t		adr;
+	u_long			_true = qtrue;
+	SOCKET			s;
+	int				clients;
+	int				seconds;
+
+	if ( Cmd_Argc() < 2 || Cmd_Argc() > 4 ) {
+		Com_Printf( "usage: netload <clients> [seconds] [address]\n" );
+		return;
+	}
+
+	NET_StopLoadTest();
+
+	clients = atoi( Cmd_Argv( 1 ) );
+	if ( clients < 1 ) {
+		return;
+	}
+	if ( clients > MAX_LOAD_CLIENTS ) {
+		clients = MAX_LOAD_CLIENTS;
+	}
+	seconds = Cmd_Argc() > 2 ? atoi( Cmd_Argv( 2 ) ) : 10;
+	if ( seconds < 1 ) {
+		seconds = 1;
+	}
+
+	if ( !NET_StringToAdr( Cmd_Argc() > 3 ? Cmd_Argv( 3 ) : va( "127.0.0.1:%i", Cvar_VariableIntegerValue( "net_port" ) ), &adr )
+		|| adr.type != NA_IP ) {
+		Com_Printf( "netload: bad address\n" );
+		return;
+	}
+	NetadrToSockadr( &adr, (struct sockaddr *)&loadTest.target );
+
+	while ( loadTest.numClients < clients ) {
+		s = socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
+		if ( s == INVALID_SOCKET ) {
+			Com_Printf( "WARNING: netload: socket: %s\n", NET_ErrorString() );
+			break;
+		}
+		if ( ioctlsocket( s, FIONBIO, &_true ) == SOCKET_ERROR ) {
+			Com_Printf( "WARNING: netload: ioctl FIONBIO: %s\n", NET_ErrorString() );
+			closesocket( s );
+			break;
+		}
+		loadTest.sockets[loadTest.numClients++] = s;
+	}
+
+	loadTest.sent = 0;
+	loadTest.received = 0;
+	loadTest.startTime = Sys_Milliseconds();
+	loadTest.endTime = loadTest.startTime + seconds * 1000;
+}
+
+/*
+====================
+NET_LoadTestFrame
+
+Reads the replies to the last frame and sends the next round
+====================
+*/
+void NET_LoadTestFrame( void ) {
+	static const char	request[] = "\xff\xff\xff\xffgetinfo netload";
+	char				reply[MAX_MSGLEN];
+	int					i;
+
+	if ( !loadTest.numClients ) {
+		return;
+	}
+
+	for ( i = 0 ; i < loadTest.numClients ; i++ ) {
+		while ( recv( loadTest.sockets[i], reply, sizeof( reply ), 0 ) > 0 ) {
+			loadTest.received++;
+		}
+	}
+
+	if ( Sys_Milliseconds() >= loadTest.endTime ) {
+		NET_StopLoadTest();
+		return;
+	}
+
+	for ( i = 0 ; i < loadTest.numClients ; i++ ) {
+		if ( sendto( loadTest.sockets[i], request, sizeof( request ) - 1, 0,
+			(struct sockaddr *)&loadTest.target, sizeof( loadTest.target ) ) != SOCKET_ERROR ) {
+			loadTest.sent++;
+		}
+	}
+}
+
+//=============================================================================
+
 /*
 ====================
 NET_Init
@@ -1004,6 +1155,7 @@ void NET_Shutdown( void ) {
 	if ( !winsockInitialized ) {
 		return;
 	}
+	NET_StopLoadTest();
 	NET_Config( qfalse );
 	WSACleanup();
 	winsockInitialized = qfalse;
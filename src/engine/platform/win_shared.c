@@ -53,6 +53,25 @@ int Sys_Milliseconds (void)
 	return sys_curtime;
 }
 
+/*
+================
+Sys_Microseconds
+================
+*/
+int Sys_Microseconds (void)
+{
+	static LARGE_INTEGER	frequency, base;
+	LARGE_INTEGER			now;
+
+	if (!frequency.QuadPart) {
+		QueryPerformanceFrequency(&frequency);
+		QueryPerformanceCounter(&base);
+	}
+	QueryPerformanceCounter(&now);
+
+	return (int)((now.QuadPart - base.QuadPart) * 1000000 / frequency.QuadPart);
+}
+
 /*
 ================
 Sys_SnapVector
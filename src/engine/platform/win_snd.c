@@ -39,6 +39,18 @@ static LPDIRECTSOUND pDS;
 static LPDIRECTSOUNDBUFFER pDSBuf, pDSPBuf;
 static HINSTANCE hInstDS;
 
+// s_nullDevice keeps the whole mixer running against a memory buffer
+// that drains in real time, so headless runs exercise the same paths
+#define NULL_DEVICE_SAMPLES		0x8000
+static qboolean	nullDevice;
+static int		nullDeviceStartTime;
+
+// a device error on the mixer thread is left here for the main thread,
+// which owns the console and the shutdown
+static volatile HRESULT	deviceLostError;
+
+static qboolean SNDDMA_OnMixThread( void );
+
 
 static const char *DSoundError( int error ) {
 	switch ( error ) {
@@ -63,6 +75,15 @@ SNDDMA_Shutdown
 void SNDDMA_Shutdown( void ) {
 	Com_DPrintf( "Shutting down sound system\n" );
 
+	if ( nullDevice ) {
+		Z_Free( dma.buffer );
+		nullDevice = qfalse;
+		memset ((void *)&dma, 0, sizeof (dma));
+		return;
+	}
+
+	deviceLostError = DS_OK;
+
 	if ( pDS ) {
 		Com_DPrintf( "Destroying DS buffers\n" );
 		if ( pDS )
@@ -107,6 +128,28 @@ void SNDDMA_Shutdown( void ) {
 	CoUninitialize( );
 }
 
+/*
+==================
+SNDDMA_InitNull
+
+Same format as the DirectSound buffer, but nobody ever reads it
+==================
+*/
+static qboolean SNDDMA_InitNull( void ) {
+	Com_Printf( "Initializing null sound device\n" );
+
+	dma.channels = 2;
+	dma.samplebits = 16;
+	dma.speed = 22050;
+	dma.samples = NULL_DEVICE_SAMPLES;
+	dma.submission_chunk = 1;
+	dma.buffer = Z_Malloc( dma.samples * dma.samplebits / 8 );
+
+	nullDevice = qtrue;
+	nullDeviceStartTime = Sys_Milliseconds();
+	return qtrue;
+}
+
 /*
 ==================
 SNDDMA_Init
@@ -120,6 +163,10 @@ qboolean SNDDMA_Init(void) {
 	memset ((void *)&dma, 0, sizeof (dma));
 	dsound_init = (qboolean) 0;
 
+	if ( Cvar_Get( "s_nullDevice", "0", CVAR_LATCH )->integer ) {
+		return SNDDMA_InitNull();
+	}
+
 	CoInitialize(NULL);
 
 	if ( !SNDDMA_InitDS () ) {
@@ -271,6 +318,12 @@ int SNDDMA_GetDMAPos( void ) {
 	int		s;
 	DWORD	dwWrite;
 
+	if ( nullDevice ) {
+		// play position advances with the wall clock
+		s = (int)( (__int64)( Sys_Milliseconds() - nullDeviceStartTime ) * dma.speed * dma.channels / 1000 );
+		return s & (dma.samples-1);
+	}
+
 	if ( !dsound_init ) {
 		return 0;
 	}
@@ -305,9 +358,16 @@ void SNDDMA_BeginPainting( void ) {
 		return;
 	}
 
+	dma.buffer = NULL;
+	if ( deviceLostError != DS_OK ) {
+		return;		// waiting for S_Update to shut down
+	}
+
 	// if the buffer was lost or stopped, restore it and/or restart it
 	if ( pDSBuf->lpVtbl->GetStatus (pDSBuf, &dwStatus) != DS_OK ) {
-		Com_Printf ("Couldn't get sound buffer status\n");
+		if ( !SNDDMA_OnMixThread() ) {
+			Com_Printf ("Couldn't get sound buffer status\n");
+		}
 	}
 	
 	if (dwStatus & DSBSTATUS_BUFFERLOST)
@@ -319,13 +379,16 @@ void SNDDMA_BeginPainting( void ) {
 	// lock the dsound buffer
 
 	reps = 0;
-	dma.buffer = NULL;
 
 	while ((hresult = pDSBuf->lpVtbl->Lock(pDSBuf, 0, gSndBufSize, (LPVOID*) &pbuf, &locksize, 
 								   (LPVOID*) &pbuf2, &dwSize2, 0)) != DS_OK)
 	{
 		if (hresult != DSERR_BUFFERLOST)
 		{
+			if ( SNDDMA_OnMixThread() ) {
+				deviceLostError = hresult;
+				return;
+			}
 			Com_Printf( "SNDDMA_BeginPainting: Lock failed with error '%s'\n", DSoundError( hresult ) );
 			S_Shutdown ();
 			return;
@@ -369,10 +432,127 @@ void SNDDMA_Activate( void ) {
 		return;
 	}
 
+	SNDDMA_LockMixer();
 	if ( DS_OK != pDS->lpVtbl->SetCooperativeLevel( pDS, g_wv.hWnd, DSSCL_PRIORITY ) )	{
 		Com_Printf ("sound SetCooperativeLevel failed\n");
 		SNDDMA_Shutdown ();
 	}
+	SNDDMA_UnlockMixer();
+}
+
+/*
+===========================================================
+
+Mixer thread
+
+===========================================================
+*/
+
+static HANDLE			mixThreadHandle;
+static DWORD			mixThreadId;
+static CRITICAL_SECTION	mixCrit;
+static volatile qboolean	mixThreadQuit;
+static void				(*mixThreadFunc)( void );
+
+static DWORD WINAPI SNDDMA_MixThread( LPVOID param ) {
+	while ( !mixThreadQuit ) {
+		EnterCriticalSection( &mixCrit );
+		mixThreadFunc();
+		LeaveCriticalSection( &mixCrit );
+
+		// s_mixahead is far longer than this, so the device never starves
+		Sleep( 5 );
+	}
+	return 0;
+}
+
+/*
+=================
+SNDDMA_BeginMixThread
+
+mixFunc is called repeatedly with the mixer lock held
+=================
+*/
+qboolean SNDDMA_BeginMixThread( void (*mixFunc)( void ) ) {
+	if ( mixThreadHandle ) {
+		return qtrue;
+	}
+
+	InitializeCriticalSection( &mixCrit );
+	mixThreadFunc = mixFunc;
+	mixThreadQuit = qfalse;
+
+	mixThreadHandle = CreateThread( NULL, 0, SNDDMA_MixThread, NULL, 0, &mixThreadId );
+	if ( !mixThreadHandle ) {
+		DeleteCriticalSection( &mixCrit );
+		return qfalse;
+	}
+	SetThreadPriority( mixThreadHandle, THREAD_PRIORITY_ABOVE_NORMAL );
+	return qtrue;
+}
+
+/*
+=================
+SNDDMA_EndMixThread
+
+Main thread only
+=================
+*/
+void SNDDMA_EndMixThread( void ) {
+	if ( !mixThreadHandle ) {
+		return;
+	}
+
+	mixThreadQuit = qtrue;
+	WaitForSingleObject( mixThreadHandle, INFINITE );
+	CloseHandle( mixThreadHandle );
+	DeleteCriticalSection( &mixCrit );
+	mixThreadHandle = NULL;
+	mixThreadId = 0;
+}
+
+/*
+=================
+SNDDMA_OnMixThread
+=================
+*/
+static qboolean SNDDMA_OnMixThread( void ) {
+	return ( mixThreadHandle && GetCurrentThreadId() == mixThreadId ) ? qtrue : qfalse;
+}
+
+/*
+=================
+SNDDMA_DeviceLost
+
+Polled by the main thread, qtrue once the mixer thread has hit a device
+error that needs sound shut down
+=================
+*/
+qboolean SNDDMA_DeviceLost( void ) {
+	if ( deviceLostError == DS_OK ) {
+		return qfalse;
+	}
+	Com_Printf( "SNDDMA_BeginPainting: Lock failed with error '%s'\n", DSoundError( deviceLostError ) );
+	return qtrue;
+}
+
+/*
+=================
+SNDDMA_LockMixer
+
+Recursive; a no-op when there is no mixer thread
+=================
+*/
+void SNDDMA_LockMixer( void ) {
+	if ( mixThreadHandle ) {
+		EnterCriticalSection( &mixCrit );
+	}
+}
+
+void SNDDMA_UnlockMixer( void ) {
+	if ( mixThreadHandle ) {
+		LeaveCriticalSection( &mixCrit );
+	}
 }
 
 
@@ -1170,6 +1170,8 @@ void CM_Trace( trace_t *results, const vec3_t start, const vec3_t end, vec3_t mi
 		return;	// map not loaded, shouldn't happen
 	}
 
+	PROF_BEGIN_DETAIL( "CM_Trace" );
+
 	// allow NULL to be passed in for 0,0,0
 	if ( !mins ) {
 		mins = vec3_origin;
@@ -1357,6 +1359,8 @@ void CM_Trace( trace_t *results, const vec3_t start, const vec3_t end, vec3_t mi
                tw.trace.fraction == 1.0 ||
                VectorLengthSquared(tw.trace.plane.normal) > 0.9999);
 	*results = tw.trace;
+
+	PROF_END_DETAIL();
 }
 
 /*
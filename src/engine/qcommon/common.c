@@ -90,6 +90,11 @@ int		time_game;
 int		time_frontend;		// renderer frontend time
 int		time_backend;		// renderer backend time
 
+// the oldest input and packet events handled this frame, to report how
+// long they waited until the frame that used them was done
+static int	com_firstInputUsec;
+static int	com_firstPacketUsec;
+
 int			com_frameTime;
 int			com_frameMsec;
 int			com_frameNumber;
@@ -1945,6 +1950,7 @@ sysEvent_t	Com_GetRealEvent( void ) {
 				Com_Error( ERR_FATAL, "Error reading from journal file" );
 			}
 		}
+		ev.evUsec = 0;		// from another run
 	} else {
 		ev = Sys_GetEvent();
 
@@ -2089,6 +2095,16 @@ int Com_EventLoop( void ) {
 		}
 
 
+		if ( ev.evUsec ) {
+			if ( ev.evType == SE_PACKET ) {
+				if ( !com_firstPacketUsec ) {
+					com_firstPacketUsec = ev.evUsec;
+				}
+			} else if ( !com_firstInputUsec ) {
+				com_firstInputUsec = ev.evUsec;
+			}
+		}
+
 		switch ( ev.evType ) {
 		default:
 		  // bk001129 - was ev.evTime
@@ -2462,6 +2478,7 @@ void Com_Init( char *commandLine ) {
 	Sys_Init();
 	Netchan_Init( Com_Milliseconds() & 0xffff );	// pick a port value that should be nice and random
 	VM_Init();
+	Prof_Init();
 	SV_Init();
 
 	com_dedicated->modified = qfalse;
@@ -2650,6 +2667,8 @@ void Com_Frame( void ) {
 		return;			// an ERR_DROP was thrown
 	}
 
+	Prof_Frame();
+
 	// bk001204 - init to zero.
 	//  also:  might be clobbered by `longjmp' or `vfork'
 	timeBeforeFirstEvents =0;
@@ -2761,6 +2780,7 @@ void Com_Frame( void ) {
 	//
 	if ( com_speeds->integer ) {
 		int			all, sv, ev, cl;
+		int			now, inLatency, packetLatency;
 
 		all = timeAfter - timeBeforeServer;
 		sv = timeBeforeEvents - timeBeforeServer;
@@ -2769,9 +2789,19 @@ void Com_Frame( void ) {
 		sv -= time_game;
 		cl -= time_frontend + time_backend;
 
-		Com_Printf ("frame:%i all:%3i sv:%3i ev:%3i cl:%3i gm:%3i rf:%3i bk:%3i\n", 
-					 com_frameNumber, all, sv, ev, cl, time_game, time_frontend, time_backend );
+		// queue to end of frame, in usec
+		now = Sys_Microseconds();
+		inLatency = com_firstInputUsec ? now - com_firstInputUsec : 0;
+		packetLatency = com_firstPacketUsec ? now - com_firstPacketUsec : 0;
+
+		Com_Printf ("frame:%i all:%3i sv:%3i ev:%3i cl:%3i gm:%3i rf:%3i bk:%3i in:%5i pk:%5i\n", 
+					 com_frameNumber, all, sv, ev, cl, time_game, time_frontend, time_backend,
+					 inLatency, packetLatency );
 	}	
+	com_firstInputUsec = 0;
+	com_firstPacketUsec = 0;
+
+	VM_Frame();
 
 	//
 	// trace optimization tracking
@@ -658,6 +658,31 @@ fileHandle_t FS_SV_FOpenFileWrite( const char *filename ) {
 	return f;
 }
 
+/*
+===========
+FS_SV_CreateOSPath
+
+Returns the file below the home path that FS_SV_FOpenFileWrite would open,
+with its directories created, for writers outside the filesystem like the
+HTTP download thread. NULL if the path can't be created.
+===========
+*/
+const char *FS_SV_CreateOSPath( const char *filename ) {
+	char *ospath;
+
+	if ( !fs_searchpaths ) {
+		Com_Error( ERR_FATAL, "Filesystem call made without initialization\n" );
+	}
+
+	ospath = FS_BuildOSPath( fs_homepath->string, filename, "" );
+	ospath[strlen(ospath)-1] = '\0';
+
+	if( FS_CreatePath( ospath ) ) {
+		return NULL;
+	}
+	return ospath;
+}
+
 /*
 ===========
 FS_SV_FOpenFileRead
@@ -821,9 +846,9 @@ void FS_FCloseFile( fileHandle_t f ) {
 		Com_Error( ERR_FATAL, "Filesystem call made without initialization\n" );
 	}
 
-	if (fsh[f].streamed) {
-		Sys_EndStreamedFile(f);
-	}
+	// the stream thread may still be reading ahead on it
+	Sys_EndStreamedFile(f);
+
 	if (fsh[f].zipFile == qtrue) {
 		unzCloseCurrentFile( fsh[f].handleFiles.file.z );
 		if ( fsh[f].handleFiles.unique ) {
@@ -1144,6 +1169,8 @@ int FS_FOpenFileRead( const char *filename, fileHandle_t *file, qboolean uniqueF
 					Com_Memcpy( zfi, pak->handle, sizeof(unz_s) );
 					// we copy this back into the structure
 					zfi->file = temp;
+					// a unique file can be read ahead on the stream thread
+					zfi->threadSafeAlloc = uniqueFILE;
 					// open the file in the zip
 					unzOpenCurrentFile( fsh[*file].handleFiles.file.z );
 					fsh[*file].zipFilePos = pakFile->pos;
@@ -1297,6 +1324,26 @@ int FS_Read( void *buffer, int len, fileHandle_t f ) {
 	}
 }
 
+/*
+=================
+FS_ReadFromThread
+
+FS_Read for the stream thread. It never errors out and doesn't add to
+fs_readCount, and a pk3 file has to have been opened unique so that
+inflate allocates outside the zone
+=================
+*/
+int FS_ReadFromThread( void *buffer, int len, fileHandle_t f ) {
+	int		r;
+
+	if ( fsh[f].zipFile == qfalse ) {
+		return (int)fread( buffer, 1, len, fsh[f].handleFiles.file.o );
+	}
+
+	r = unzReadCurrentFile( fsh[f].handleFiles.file.z, buffer, len );
+	return r < 0 ? 0 : r;
+}
+
 /*
 =================
 FS_Write
@@ -3105,6 +3152,29 @@ const char *FS_ReferencedPakNames( void ) {
 	return info;
 }
 
+/*
+=====================
+FS_PakOSPath
+=====================
+*/
+const char *FS_PakOSPath( const char *gamePakName ) {
+	searchpath_t	*search;
+	int				len;
+
+	for ( search = fs_searchpaths ; search ; search = search->next ) {
+		if ( !search->pack ) {
+			continue;
+		}
+		len = (int)strlen( search->pack->pakGamename );
+		if ( !Q_stricmpn( gamePakName, search->pack->pakGamename, len ) && gamePakName[len] == '/'
+			&& !Q_stricmp( gamePakName + len + 1, search->pack->pakBasename ) ) {
+			return search->pack->pakFilename;
+		}
+	}
+
+	return NULL;
+}
+
 /*
 =====================
 FS_ClearPakReferences
@@ -3391,12 +3461,9 @@ int		FS_FOpenFileByMode( const char *qpath, fileHandle_t *f, fsMode_t mode ) {
 			fsh[*f].baseOffset = ftell(fsh[*f].handleFiles.file.o);
 		}
 		fsh[*f].fileSize = r;
-		fsh[*f].streamed = qfalse;
 
-		if (mode == FS_READ) {
-			Sys_BeginStreamedFile( *f, 0x4000 );
-			fsh[*f].streamed = qtrue;
-		}
+		// not streamed, the vm seeks and tells on these
+		fsh[*f].streamed = qfalse;
 	}
 	fsh[*f].handleSync = sync;
 
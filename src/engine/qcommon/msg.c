@@ -21,6 +21,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 */
 #include "../../game/q_shared.h"
 #include "qcommon.h"
+#include <emmintrin.h> // SSE2 is always available on x64
 
 static huffman_t		msgHuff;
 
@@ -844,6 +845,33 @@ netField_t	entityStateFields[] =
 #define	FLOAT_INT_BITS	13
 #define	FLOAT_INT_BIAS	(1<<(FLOAT_INT_BITS-1))
 
+/*
+==================
+MSG_EntityStatesEqual
+
+SSE2 compare of two whole entityStates
+==================
+*/
+static qboolean MSG_EntityStatesEqual( const entityState_t *a, const entityState_t *b ) {
+	const __m128i	*va = (const __m128i *)a;
+	const __m128i	*vb = (const __m128i *)b;
+	__m128i			diff;
+	int				numVectors;
+	int				i;
+
+	numVectors = (int)( sizeof( entityState_t ) / 16 );
+	diff = _mm_setzero_si128();
+	for ( i = 0 ; i < numVectors ; i++ ) {
+		diff = _mm_or_si128( diff, _mm_xor_si128( _mm_loadu_si128( va + i ), _mm_loadu_si128( vb + i ) ) );
+	}
+	if ( _mm_movemask_epi8( _mm_cmpeq_epi32( diff, _mm_setzero_si128() ) ) != 0xffff ) {
+		return qfalse;
+	}
+
+	// whatever doesn't fill a whole vector
+	return memcmp( va + i, vb + i, sizeof( entityState_t ) % 16 ) ? qfalse : qtrue;
+}
+
 /*
 ==================
 MSG_WriteDeltaEntity
@@ -887,12 +915,17 @@ void MSG_WriteDeltaEntity( msg_t *msg, struct entityState_s *from, struct entity
 	}
 
 	lc = 0;
-	// build the change vector as bytes so it is endien independent
-	for ( i = 0, field = entityStateFields ; i < numFields ; i++, field++ ) {
-		fromF = (int *)( (byte *)from + field->offset );
-		toF = (int *)( (byte *)to + field->offset );
-		if ( *fromF != *toF ) {
-			lc = i+1;
+	// most entities in a snapshot are unchanged since the frame they are
+	// delta'd from, so a single compare of the whole state skips the
+	// field walk for them
+	if ( !MSG_EntityStatesEqual( from, to ) ) {
+		// build the change vector as bytes so it is endien independent
+		for ( i = 0, field = entityStateFields ; i < numFields ; i++, field++ ) {
+			fromF = (int *)( (byte *)from + field->offset );
+			toF = (int *)( (byte *)to + field->offset );
+			if ( *fromF != *toF ) {
+				lc = i+1;
+			}
 		}
 	}
 
@@ -0,0 +1,292 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+// profile.c -- nested frame zones with a chrome trace dump
+
+#include "../../game/q_shared.h"
+#include "qcommon.h"
+
+/*
+=============================================================================
+
+The engine brackets the interesting parts of a frame with PROF_BEGIN and
+PROF_END. Each finished zone keeps its name, its start in Sys_Microseconds
+and its duration in a ring that holds the last PROF_MAX_ZONES of them, and
+profile_dump writes the ring out as a chrome://tracing JSON file.
+
+com_profile 1 records the frame zones, 2 adds every collision trace and
+botlib call. The value is latched once a frame, so a zone can't be opened
+with profiling off and closed with it on. When it is 0 a zone costs one
+compare.
+
+Zones are only recorded from the main thread.
+
+=============================================================================
+*/
+
+#define	PROF_MAX_ZONES		0x10000		// must be a power of two
+#define	PROF_MAX_DEPTH		32
+#define	PROF_MAX_NAMES		512
+#define	PROF_NAME_HASH		1024		// power of two, more than PROF_MAX_NAMES
+#define	PROF_NAME_CHARS		0x4000
+
+typedef struct {
+	const char	*name;
+	int			start;			// Sys_Microseconds
+	int			duration;		// -1 while the zone is open
+	int			depth;
+} profZone_t;
+
+typedef struct {
+	profZone_t	zones[PROF_MAX_ZONES];
+	unsigned	numZones;		// total ever begun, the ring index is numZones & (PROF_MAX_ZONES-1)
+
+	unsigned	stack[PROF_MAX_DEPTH];
+	int			depth;			// can go past PROF_MAX_DEPTH, deeper zones aren't recorded
+
+	// names that don't outlive their caller, like those from the game vm
+	const char	*names[PROF_MAX_NAMES];
+	int			numNames;
+	int			nameHash[PROF_NAME_HASH];	// names index + 1, 0 is empty
+	char		nameChars[PROF_NAME_CHARS];
+	int			numNameChars;
+} profile_t;
+
+static profile_t	prof;
+
+cvar_t		*com_profile;
+int			com_profiling;
+
+/*
+================
+Prof_Begin
+================
+*/
+void Prof_Begin( const char *name ) {
+	profZone_t	*zone;
+
+	if ( prof.depth < PROF_MAX_DEPTH ) {
+		zone = &prof.zones[prof.numZones & ( PROF_MAX_ZONES - 1 )];
+		zone->name = name;
+		zone->depth = prof.depth;
+		zone->duration = -1;
+		zone->start = Sys_Microseconds();
+		prof.stack[prof.depth] = prof.numZones;
+		prof.numZones++;
+	}
+	prof.depth++;
+}
+
+/*
+================
+Prof_End
+================
+*/
+void Prof_End( void ) {
+	unsigned	index;
+	profZone_t	*zone;
+
+	if ( !prof.depth ) {
+		return;		// begun before a frame boundary
+	}
+	prof.depth--;
+	if ( prof.depth >= PROF_MAX_DEPTH ) {
+		return;
+	}
+
+	// the ring may have lapped a very long zone
+	index = prof.stack[prof.depth];
+	if ( prof.numZones - index > PROF_MAX_ZONES ) {
+		return;
+	}
+
+	zone = &prof.zones[index & ( PROF_MAX_ZONES - 1 )];
+	zone->duration = Sys_Microseconds() - zone->start;
+}
+
+/*
+================
+Prof_Frame
+
+Called at the start of every Com_Frame. An ERR_DROP can leave zones open,
+they are abandoned here.
+================
+*/
+void Prof_Frame( void ) {
+	prof.depth = 0;
+	com_profiling = com_profile->integer;
+}
+
+/*
+================
+Prof_InternName
+
+Returns a copy of name that stays valid until the next profile_clear
+================
+*/
+const char *Prof_InternName( const char *name ) {
+	unsigned	hash;
+	int			i, len;
+	char		*copy;
+
+	hash = 0;
+	for ( i = 0 ; name[i] ; i++ ) {
+		hash = hash * 31 + (byte)name[i];
+	}
+
+	// the table is never full, so the probe always ends on an empty slot
+	for ( i = hash & ( PROF_NAME_HASH - 1 ) ; prof.nameHash[i] ; i = ( i + 1 ) & ( PROF_NAME_HASH - 1 ) ) {
+		if ( !strcmp( prof.names[prof.nameHash[i] - 1], name ) ) {
+			return prof.names[prof.nameHash[i] - 1];
+		}
+	}
+
+	len = (int)strlen( name ) + 1;
+	if ( prof.numNames == PROF_MAX_NAMES || prof.numNameChars + len > PROF_NAME_CHARS ) {
+		return "unnamed";
+	}
+
+	copy = prof.nameChars + prof.numNameChars;
+	Com_Memcpy( copy, name, len );
+	prof.numNameChars += len;
+	prof.names[prof.numNames++] = copy;
+	prof.nameHash[i] = prof.numNames;
+
+	return copy;
+}
+
+/*
+================
+Prof_Clear_f
+================
+*/
+static void Prof_Clear_f( void ) {
+	prof.numZones = 0;
+	prof.depth = 0;
+	prof.numNames = 0;
+	prof.numNameChars = 0;
+	Com_Memset( prof.nameHash, 0, sizeof( prof.nameHash ) );
+}
+
+/*
+================
+Prof_WriteString
+
+Zone names are identifiers and classnames, but escape them anyway
+================
+*/
+static void Prof_WriteString( fileHandle_t f, const char *s ) {
+	char	buffer[MAX_STRING_CHARS];
+	int		len;
+
+	len = 0;
+	buffer[len++] = '"';
+	for ( ; *s && len < (int)sizeof( buffer ) - 4 ; s++ ) {
+		if ( *s == '"' || *s == '\\' ) {
+			buffer[len++] = '\\';
+		} else if ( (byte)*s < ' ' ) {
+			continue;
+		}
+		buffer[len++] = *s;
+	}
+	buffer[len++] = '"';
+	FS_Write( buffer, len, f );
+}
+
+/*
+================
+Prof_Dump_f
+
+profile_dump [file]
+================
+*/
+static void Prof_Dump_f( void ) {
+	char			name[MAX_QPATH];
+	fileHandle_t	f;
+	unsigned		first, i;
+	int				base, count;
+	profZone_t		*zone;
+
+	if ( Cmd_Argc() > 2 ) {
+		Com_Printf( "usage: profile_dump [file]\n" );
+		return;
+	}
+
+	if ( !prof.numZones ) {
+		Com_Printf( "No zones recorded, set com_profile 1 first.\n" );
+		return;
+	}
+
+	if ( Cmd_Argc() == 2 ) {
+		Q_strncpyz( name, Cmd_Argv( 1 ), sizeof( name ) );
+		COM_DefaultExtension( name, sizeof( name ), ".json" );
+	} else {
+		Q_strncpyz( name, "profile.json", sizeof( name ) );
+	}
+
+	f = FS_FOpenFileWrite( name );
+	if ( !f ) {
+		Com_Printf( "ERROR: couldn't open %s\n", name );
+		return;
+	}
+
+	first = 0;
+	if ( prof.numZones > PROF_MAX_ZONES ) {
+		first = prof.numZones - PROF_MAX_ZONES;
+	}
+
+	// timestamps are written relative to the oldest zone
+	base = prof.zones[first & ( PROF_MAX_ZONES - 1 )].start;
+
+	FS_Printf( f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n" );
+	count = 0;
+	for ( i = first ; i != prof.numZones ; i++ ) {
+		zone = &prof.zones[i & ( PROF_MAX_ZONES - 1 )];
+		if ( zone->duration < 0 ) {
+			continue;		// still open or abandoned
+		}
+		if ( count ) {
+			FS_Write( ",\n", 2, f );
+		}
+		FS_Printf( f, "{\"name\":" );
+		Prof_WriteString( f, zone->name );
+		FS_Printf( f, ",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%i,\"dur\":%i}",
+			zone->start - base, zone->duration );
+		count++;
+	}
+	FS_Printf( f, "\n]}\n" );
+
+	FS_FCloseFile( f );
+
+	Com_Printf( "Wrote %i zones to %s\n", count, name );
+}
+
+/*
+================
+Prof_Init
+================
+*/
+void Prof_Init( void ) {
+	com_profile = Cvar_Get( "com_profile", "0", 0 );
+
+	Cmd_AddCommand( "profile_dump", Prof_Dump_f );
+	Cmd_AddCommand( "profile_clear", Prof_Clear_f );
+}
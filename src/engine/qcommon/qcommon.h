@@ -309,6 +309,7 @@ typedef enum {
 } sharedTraps_t;
 
 void	VM_Init( void );
+void	VM_Frame( void );
 vm_t	*VM_Create( const char *module, intptr_t (*systemCalls)(intptr_t *), 
 				   vmInterpret_t interpret );
 // module should be bare: "cgame", not "cgame.dll" or "vm/cgame.qvm"
@@ -546,6 +547,8 @@ int		FS_filelength( fileHandle_t f );
 fileHandle_t FS_SV_FOpenFileWrite( const char *filename );
 int		FS_SV_FOpenFileRead( const char *filename, fileHandle_t *fp );
 void	FS_SV_Rename( const char *from, const char *to );
+const char *FS_SV_CreateOSPath( const char *filename );
+// the OS path FS_SV_FOpenFileWrite would open, with its directories created
 int		FS_FOpenFileRead( const char *qpath, fileHandle_t *file, qboolean uniqueFILE );
 // if uniqueFILE is true, then a new FILE will be fopened even if the file
 // is found in an already open pak file.  If uniqueFILE is false, you must call
@@ -562,6 +565,9 @@ int		FS_Read2( void *buffer, int len, fileHandle_t f );
 int		FS_Read( void *buffer, int len, fileHandle_t f );
 // properly handles partial reads and reads from other dlls
 
+int		FS_ReadFromThread( void *buffer, int len, fileHandle_t f );
+// a plain read for the stream thread, short on error or end of file
+
 void	FS_FCloseFile( fileHandle_t f );
 // note: you can't just fclose from another DLL, due to MS libc issues
 
@@ -611,6 +617,8 @@ const char *FS_LoadedPakPureChecksums( void );
 // Servers with sv_pure set will get this string and pass it to clients.
 
 const char *FS_ReferencedPakNames( void );
+const char *FS_PakOSPath( const char *gamePakName );
+// Returns the file a "baseq3/pak0" style name from the lists above was loaded from
 const char *FS_ReferencedPakChecksums( void );
 const char *FS_ReferencedPakPureChecksums( void );
 // Returns a space separated string containing the checksums of all loaded 
@@ -735,6 +743,31 @@ extern	qboolean	com_errorEntered;
 extern	fileHandle_t	com_journalFile;
 extern	fileHandle_t	com_journalDataFile;
 
+/*
+==============================================================
+
+PROFILE ZONES
+
+==============================================================
+*/
+
+extern	cvar_t	*com_profile;
+extern	int		com_profiling;		// com_profile, latched each frame
+
+void		Prof_Init( void );
+void		Prof_Frame( void );
+void		Prof_Begin( const char *name );
+void		Prof_End( void );
+const char	*Prof_InternName( const char *name );
+
+// every PROF_BEGIN must be matched by a PROF_END at the same level
+#define	PROF_BEGIN( name )			do { if ( com_profiling ) { Prof_Begin( name ); } } while ( 0 )
+#define	PROF_END()					do { if ( com_profiling ) { Prof_End(); } } while ( 0 )
+
+// zones that are hit often enough to swamp the ring, only with com_profile 2
+#define	PROF_BEGIN_DETAIL( name )	do { if ( com_profiling > 1 ) { Prof_Begin( name ); } } while ( 0 )
+#define	PROF_END_DETAIL()			do { if ( com_profiling > 1 ) { Prof_End(); } } while ( 0 )
+
 typedef enum {
 	TAG_FREE,
 	TAG_GENERAL,
@@ -919,6 +952,7 @@ typedef struct {
 	int				evValue, evValue2;
 	int				evPtrLength;	// bytes of data pointed to by evPtr, for journaling
 	void			*evPtr;			// this must be manually freed if not NULL
+	int				evUsec;			// Sys_Microseconds when it was queued, 0 if unknown
 } sysEvent_t;
 
 sysEvent_t	Sys_GetEvent( void );
@@ -956,6 +990,9 @@ void	Sys_Print( const char *msg );
 // any game related timing information should come from event timestamps
 int		Sys_Milliseconds (void);
 
+// Sys_Microseconds wraps about every 35 minutes, only use differences
+int		Sys_Microseconds (void);
+
 void	Sys_SnapVector( float *v );
 
 // the system console is shown when a dedicated server is running
@@ -968,6 +1005,27 @@ void	Sys_EndStreamedFile( fileHandle_t f );
 int		Sys_StreamedRead( void *buffer, int size, int count, fileHandle_t f );
 void	Sys_StreamSeek( fileHandle_t f, int offset, int origin );
 
+// the built in HTTP server that hands out pk3s on its own thread,
+// names are "baseq3/foo.pk3" style paths relative to the URL root
+#define	MAX_HTTP_FILES	256
+
+void	Sys_StartDownloadServer( int port );
+void	Sys_StopDownloadServer( void );
+void	Sys_SetDownloadFiles( int numFiles, const char **names, const char **osPaths );
+
+// fetches an http:// url into a file on its own thread, the client
+// polls the status once a frame and ends it when it is no longer running
+typedef enum {
+	HTTPDL_IDLE,
+	HTTPDL_RUNNING,
+	HTTPDL_DONE,
+	HTTPDL_FAILED
+} httpDownloadStatus_t;
+
+qboolean	Sys_BeginHTTPDownload( const char *url, const char *osPath );
+httpDownloadStatus_t	Sys_HTTPDownloadStatus( int *count, int *size );
+void	Sys_EndHTTPDownload( void );
+
 void	Sys_ShowConsole( int level, qboolean quitOnClose );
 void	Sys_SetErrorText( const char *text );
 
@@ -1042,6 +1042,8 @@ typedef unsigned long  ulg;
 typedef uLong (*check_func) OF((uLong check, const Byte *buf, uInt len));
 static voidp zcalloc OF((voidp opaque, unsigned items, unsigned size));
 static void   zcfree  OF((voidp opaque, voidp ptr));
+static voidp zsyscalloc OF((voidp opaque, unsigned items, unsigned size));
+static void   zsysfree  OF((voidp opaque, voidp ptr));
 
 #define ZALLOC(strm, items, size) \
            (*((strm)->zalloc))((strm)->opaque, (items), (size))
@@ -1917,8 +1919,17 @@ extern int unzOpenCurrentFile (unzFile file)
 
 	if (!Store)
 	{
-	  pfile_in_zip_read_info->stream.zalloc = (alloc_func)0;
-	  pfile_in_zip_read_info->stream.zfree = (free_func)0;
+	  if (s->threadSafeAlloc)
+	  {
+	    /* the zone isn't thread safe, and inflate allocates as it goes */
+	    pfile_in_zip_read_info->stream.zalloc = (alloc_func)zsyscalloc;
+	    pfile_in_zip_read_info->stream.zfree = (free_func)zsysfree;
+	  }
+	  else
+	  {
+	    pfile_in_zip_read_info->stream.zalloc = (alloc_func)0;
+	    pfile_in_zip_read_info->stream.zfree = (free_func)0;
+	  }
 	  pfile_in_zip_read_info->stream.opaque = (voidp)0; 
       
 	  err=inflateInit2(&pfile_in_zip_read_info->stream, -MAX_WBITS);
@@ -4303,4 +4314,16 @@ void  zcfree (voidp opaque, voidp ptr)
     if (opaque) return; /* make compiler happy */
 }
 
+voidp zsyscalloc (voidp opaque, unsigned items, unsigned size)
+{
+    if (opaque) items += size - size; /* make compiler happy */
+    return (voidp)calloc(items, size);
+}
+
+void  zsysfree (voidp opaque, voidp ptr)
+{
+    free(ptr);
+    if (opaque) return; /* make compiler happy */
+}
+
 
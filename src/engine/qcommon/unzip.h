@@ -152,6 +152,7 @@ typedef struct
 	                                    file if we are decompressing it */
 	unsigned char*	tmpFile;
 	int	tmpPos,tmpSize;
+	int	threadSafeAlloc;	/* inflate allocates with malloc, so another thread can read */
 } unz_s;
 
 #define UNZ_OK                                  (0)
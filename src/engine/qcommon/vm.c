@@ -44,8 +44,12 @@ int		vm_debugLevel;
 vm_t	vmTable[MAX_VM];
 
 
+cvar_t	*vm_statInterval;
+static int	vm_nextStatTime;
+
 void VM_VmInfo_f( void );
 void VM_VmProfile_f( void );
+void VM_VmStat_f( void );
 
 void VM_Debug( int level ) {
 	vm_debugLevel = level;
@@ -63,6 +67,9 @@ void VM_Init( void ) {
 
 	Cmd_AddCommand ("vmprofile", VM_VmProfile_f );
 	Cmd_AddCommand ("vminfo", VM_VmInfo_f );
+	Cmd_AddCommand ("vmstat", VM_VmStat_f );
+
+	vm_statInterval = Cvar_Get( "vm_statInterval", "0", 0 );
 
 	Com_Memset( vmTable, 0, sizeof( vmTable ) );
 }
@@ -261,7 +268,40 @@ intptr_t QDECL VM_DllSyscall( intptr_t arg, ... ) {
     args[i] = va_arg(ap, intptr_t);
   va_end(ap);
   
-  return currentVM->systemCall( args );
+  return VM_SystemCall( currentVM, args );
+}
+
+/*
+=================
+VM_SystemCall
+
+Every trap from either kind of module comes through here. The count is
+exact, the time is measured on every VM_STAT_SAMPLE'th call of each trap
+and scaled up by vmstat, to keep the timer off the hot path.
+=================
+*/
+intptr_t VM_SystemCall( vm_t *vm, intptr_t *args ) {
+	vmStat_t	*stat;
+	intptr_t	r;
+	int			start;
+
+	if ( (uintptr_t)args[0] < MAX_VM_SYSCALLS ) {
+		stat = &vm->syscallStats[args[0]];
+	} else {
+		stat = &vm->syscallStats[MAX_VM_SYSCALLS - 1];
+	}
+
+	stat->count++;
+	if ( stat->count & ( VM_STAT_SAMPLE - 1 ) ) {
+		return vm->systemCall( args );
+	}
+
+	start = Sys_Microseconds();
+	r = vm->systemCall( args );
+	stat->sampledUsec += Sys_Microseconds() - start;
+	stat->samples++;
+
+	return r;
 }
 
 /*
@@ -584,12 +624,20 @@ intptr_t	QDECL VM_Call( vm_t *vm, int callnum, ... ) {
 	int i;
 	int args[16];
 	va_list ap;
+	vmStat_t	*stat;
+	int		start;
 
 
 	if ( !vm ) {
 		Com_Error( ERR_FATAL, "VM_Call with NULL vm" );
 	}
 
+	PROF_BEGIN( vm->name );
+
+	// there are only a few calls a frame, time all of them
+	stat = &vm->callStats[(unsigned)callnum < MAX_VM_CALLS ? callnum : MAX_VM_CALLS - 1];
+	start = Sys_Microseconds();
+
 	oldVM = currentVM;
 	currentVM = vm;
 	lastVM = vm;
@@ -630,6 +678,12 @@ intptr_t	QDECL VM_Call( vm_t *vm, int callnum, ... ) {
 
 	if ( oldVM != NULL ) // bk001220 - assert(currentVM!=NULL) for oldVM==NULL
 	  currentVM = oldVM;
+
+	stat->count++;
+	stat->samples++;
+	stat->sampledUsec += Sys_Microseconds() - start;
+
+	PROF_END();
 	return r;
 }
 
@@ -725,6 +779,156 @@ void VM_VmInfo_f( void ) {
 	}
 }
 
+/*
+==============
+VM_StatTime
+
+Estimated total msec, from the sampled calls
+==============
+*/
+static double VM_StatTime( const vmStat_t *stat ) {
+	if ( !stat->samples ) {
+		return 0;
+	}
+	return stat->sampledUsec * stat->count / stat->samples * 0.001;
+}
+
+static const vmStat_t	*vm_sortStats;
+
+static int QDECL VM_StatSort( const void *a, const void *b ) {
+	double	ta, tb;
+
+	ta = VM_StatTime( &vm_sortStats[*(const int *)a] );
+	tb = VM_StatTime( &vm_sortStats[*(const int *)b] );
+
+	if ( ta > tb ) {
+		return -1;
+	}
+	if ( ta < tb ) {
+		return 1;
+	}
+	return 0;
+}
+
+/*
+==============
+VM_PrintStatTable
+
+Busiest first, by estimated time
+==============
+*/
+static void VM_PrintStatTable( const char *title, const vmStat_t *stats, int numStats, int limit ) {
+	int		order[MAX_VM_SYSCALLS];
+	int		i, count;
+	double	msec;
+
+	count = 0;
+	for ( i = 0 ; i < numStats ; i++ ) {
+		if ( stats[i].count ) {
+			order[count++] = i;
+		}
+	}
+	if ( !count ) {
+		return;
+	}
+
+	vm_sortStats = stats;
+	qsort( order, count, sizeof( order[0] ), VM_StatSort );
+
+	Com_Printf( "  %-8s %10s %10s %9s\n", title, "calls", "msec", "usec/call" );
+	for ( i = 0 ; i < count && i < limit ; i++ ) {
+		const vmStat_t	*stat = &stats[order[i]];
+
+		msec = VM_StatTime( stat );
+		Com_Printf( "  %4i%s    %10u %10.1f %9.2f\n", order[i],
+			( numStats == MAX_VM_SYSCALLS && order[i] == MAX_VM_SYSCALLS - 1 ) ? "+" : " ",
+			stat->count, msec, msec * 1000 / stat->count );
+	}
+}
+
+/*
+==============
+VM_PrintStats
+==============
+*/
+static void VM_PrintStats( int limit, qboolean reset ) {
+	vm_t	*vm;
+	int		i;
+
+	for ( i = 0 ; i < MAX_VM ; i++ ) {
+		vm = &vmTable[i];
+		if ( !vm->name[0] ) {
+			continue;
+		}
+		Com_Printf( "%s:\n", vm->name );
+		VM_PrintStatTable( "trap", vm->syscallStats, MAX_VM_SYSCALLS, limit );
+		VM_PrintStatTable( "vmMain", vm->callStats, MAX_VM_CALLS, limit );
+
+		if ( reset ) {
+			Com_Memset( vm->syscallStats, 0, sizeof( vm->syscallStats ) );
+			Com_Memset( vm->callStats, 0, sizeof( vm->callStats ) );
+		}
+	}
+}
+
+/*
+==============
+VM_VmStat_f
+
+vmstat [count] [reset]
+
+Trap numbers are the G_*, CG_* and UI_* enums from the module's public
+header, vmMain commands the GAME_*, CG_* and UI_* exports.
+==============
+*/
+void VM_VmStat_f( void ) {
+	int			limit;
+	qboolean	reset;
+	int			i;
+
+	limit = 20;
+	reset = qfalse;
+	for ( i = 1 ; i < Cmd_Argc() ; i++ ) {
+		if ( !Q_stricmp( Cmd_Argv( i ), "reset" ) ) {
+			reset = qtrue;
+		} else {
+			limit = atoi( Cmd_Argv( i ) );
+		}
+	}
+
+	VM_PrintStats( limit > 0 ? limit : MAX_VM_SYSCALLS, reset );
+}
+
+/*
+==============
+VM_Frame
+
+Prints and resets the counters every vm_statInterval seconds, so a
+server log shows what dominated each stretch of play
+==============
+*/
+void VM_Frame( void ) {
+	int		now;
+
+	if ( vm_statInterval->integer <= 0 ) {
+		vm_nextStatTime = 0;
+		return;
+	}
+
+	now = Sys_Milliseconds();
+	if ( !vm_nextStatTime ) {
+		vm_nextStatTime = now + vm_statInterval->integer * 1000;
+		return;
+	}
+	if ( now - vm_nextStatTime < 0 ) {
+		return;
+	}
+	vm_nextStatTime = now + vm_statInterval->integer * 1000;
+
+	Com_Printf( "vmstat, last %i seconds:\n", vm_statInterval->integer );
+	VM_PrintStats( 10, qtrue );
+}
+
 /*
 ===============
 VM_LogSyscalls
@@ -520,7 +520,7 @@ nextInstruction2:
                     argarr[i] = *imagePtr;
                     imagePtr++;
                 }
-                r = vm->systemCall( argarr );
+                r = VM_SystemCall( vm, argarr );
             }
 
 #ifdef DEBUG_VM
@@ -124,6 +124,17 @@ typedef struct vmSymbol_s {
 	char	symName[1];		// variable sized
 } vmSymbol_t;
 
+// runtime counters for vmstat
+#define	MAX_VM_SYSCALLS		1024		// larger trap numbers share the last slot
+#define	MAX_VM_CALLS		64			// vmMain commands
+#define	VM_STAT_SAMPLE		16			// time one in this many traps, power of two
+
+typedef struct {
+	unsigned	count;
+	unsigned	samples;			// calls that were timed
+	double		sampledUsec;		// time spent in those
+} vmStat_t;
+
 #define	VM_OFFSET_PROGRAM_STACK		0
 #define	VM_OFFSET_SYSTEM_CALL		4
 
@@ -164,6 +175,9 @@ struct vm_s {
 
 // fqpath member added 7/20/02 by T.Ray
 	char		fqpath[MAX_QPATH+1] ;
+
+	vmStat_t	syscallStats[MAX_VM_SYSCALLS];
+	vmStat_t	callStats[MAX_VM_CALLS];
 };
 
 
@@ -177,4 +191,5 @@ vmSymbol_t *VM_ValueToFunctionSymbol( vm_t *vm, int value );
 int VM_SymbolToValue( vm_t *vm, const char *symbol );
 const char *VM_ValueToSymbol( vm_t *vm, int value );
 void VM_LogSyscalls( int *args );
+intptr_t VM_SystemCall( vm_t *vm, intptr_t *args );
 
@@ -1425,6 +1425,15 @@ static	void R_LoadNodesAndLeafs (lump_t *nodeLump, lump_t *leafLump) {
 
 	// chain decendants
 	R_SetParent (s_worldData.nodes, NULL);
+
+	// room for every leaf in the visible list, padded so the last
+	// group of four can be loaded whole
+	numLeafs = ( numLeafs + 3 ) & ~3;
+	s_worldData.visLeafs = (mnode_t **) ri.Hunk_Alloc( numLeafs * sizeof( mnode_t * ), h_low );
+	s_worldData.visLeafBounds[0] = (float *) ri.Hunk_Alloc( 6 * numLeafs * sizeof( float ), h_low );
+	for ( j = 1 ; j < 6 ; j++ ) {
+		s_worldData.visLeafBounds[j] = s_worldData.visLeafBounds[j-1] + numLeafs;
+	}
 }
 
 //=============================================================================
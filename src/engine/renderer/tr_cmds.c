@@ -58,12 +58,26 @@ void R_PerformanceCounters( void ) {
 			ri.Printf (PRINT_ALL, "dlight srf:%i  culled:%i  verts:%i  tris:%i\n", 
 				tr.pc.c_dlightSurfaces, tr.pc.c_dlightSurfacesCulled,
 				backEnd.pc.c_dlightVertexes, backEnd.pc.c_dlightIndexes / 3 );
+			ri.Printf (PRINT_ALL, "dlight offscreen:%i  rejected:%i  draws:%i\n", 
+				tr.pc.c_dlightsCulled, backEnd.pc.c_dlightsRejected, backEnd.pc.c_dlightDraws );
 		}
 	} 
 	else if (r_speeds->integer == 5 )
 	{
 		ri.Printf( PRINT_ALL, "zFar: %.0f\n", tr.viewParms.zFar );
 	}
+	else if (r_speeds->integer == 6 )
+	{
+		ri.Printf( PRINT_ALL, "%i surfs %i verts %i draws %.1f KB streamed\n",
+			backEnd.pc.c_surfaces, backEnd.pc.c_vertexes, backEnd.pc.c_draws,
+			backEnd.pc.c_bytesStreamed / 1024.0f );
+	}
+	else if (r_speeds->integer == 7 )
+	{
+		ri.Printf( PRINT_ALL, "%i/%i pipeline binds/skipped %i/%i descriptor binds/skipped\n",
+			backEnd.pc.c_pipelineBinds, backEnd.pc.c_pipelineBindsSkipped,
+			backEnd.pc.c_descriptorBinds, backEnd.pc.c_descriptorBindsSkipped );
+	}
 
 	Com_Memset( &tr.pc, 0, sizeof( tr.pc ) );
 	Com_Memset( &backEnd.pc, 0, sizeof( backEnd.pc ) );
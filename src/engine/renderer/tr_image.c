@@ -22,6 +22,8 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 // tr_image.c
 #include "tr_local.h"
 
+#include <emmintrin.h> // SSE2 is always available on x64
+
 static void* q3_stbi_malloc(size_t size) {
     return ri.Malloc((int)size);
 }
@@ -473,7 +475,21 @@ static void R_MipMap (byte *in, int width, int height) {
 	}
 
 	for (i=0 ; i<height ; i++, in+=row) {
-		for (j=0 ; j<width ; j++, out+=4, in+=8) {
+		// two output pixels per iteration, same rounding as the scalar loop below
+		const __m128i zero = _mm_setzero_si128();
+		for (j=0 ; j+2<=width ; j+=2, out+=8, in+=16) {
+			__m128i r0 = _mm_loadu_si128((const __m128i *)in);
+			__m128i r1 = _mm_loadu_si128((const __m128i *)(in + row));
+
+			__m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(r0, zero), _mm_unpacklo_epi8(r1, zero));
+			__m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(r0, zero), _mm_unpackhi_epi8(r1, zero));
+			lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+			hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+
+			__m128i sum = _mm_srli_epi16(_mm_unpacklo_epi64(lo, hi), 2);
+			_mm_storel_epi64((__m128i *)out, _mm_packus_epi16(sum, sum));
+		}
+		for ( ; j<width ; j++, out+=4, in+=8) {
 			out[0] = (in[0] + in[4] + in[row+0] + in[row+4])>>2;
 			out[1] = (in[1] + in[5] + in[row+1] + in[row+5])>>2;
 			out[2] = (in[2] + in[6] + in[row+2] + in[row+6])>>2;
@@ -1202,6 +1218,32 @@ TARGA LOADING
 =========================================================
 */
 
+/*
+=============
+R_CopyBGRAToRGBA
+
+Swaps red and blue channels while copying count 32 bit pixels
+=============
+*/
+static void R_CopyBGRAToRGBA( const byte *in, byte *out, int count ) {
+	const __m128i greenAlpha = _mm_set1_epi32( (int)0xFF00FF00 );
+	const __m128i lowByte = _mm_set1_epi32( 0x000000FF );
+	int i;
+
+	for ( i = 0; i + 4 <= count; i += 4, in += 16, out += 16 ) {
+		__m128i p = _mm_loadu_si128( (const __m128i *)in );
+		__m128i r = _mm_and_si128( _mm_srli_epi32( p, 16 ), lowByte );
+		__m128i b = _mm_slli_epi32( _mm_and_si128( p, lowByte ), 16 );
+		_mm_storeu_si128( (__m128i *)out, _mm_or_si128( _mm_and_si128( p, greenAlpha ), _mm_or_si128( r, b ) ) );
+	}
+	for ( ; i < count; i++, in += 4, out += 4 ) {
+		out[0] = in[2];
+		out[1] = in[1];
+		out[2] = in[0];
+		out[3] = in[3];
+	}
+}
+
 /*
 =============
 LoadTGA
@@ -1287,55 +1329,41 @@ static void LoadTGA ( const char *name, byte **pic, int *width, int *height)
 		for(row=rows-1; row>=0; row--) 
 		{
 			pixbuf = targa_rgba + row*columns*4;
-			for(column=0; column<columns; column++) 
+			switch (targa_header.pixel_size) 
 			{
-				unsigned char red,green,blue,alphabyte;
-				switch (targa_header.pixel_size) 
+			case 8:
+				for(column=0; column<columns; column++, pixbuf+=4) 
 				{
-					
-				case 8:
-					blue = *buf_p++;
-					green = blue;
-					red = blue;
-					*pixbuf++ = red;
-					*pixbuf++ = green;
-					*pixbuf++ = blue;
-					*pixbuf++ = 255;
-					break;
-
-				case 24:
-					blue = *buf_p++;
-					green = *buf_p++;
-					red = *buf_p++;
-					*pixbuf++ = red;
-					*pixbuf++ = green;
-					*pixbuf++ = blue;
-					*pixbuf++ = 255;
-					break;
-				case 32:
-					blue = *buf_p++;
-					green = *buf_p++;
-					red = *buf_p++;
-					alphabyte = *buf_p++;
-					*pixbuf++ = red;
-					*pixbuf++ = green;
-					*pixbuf++ = blue;
-					*pixbuf++ = alphabyte;
-					break;
-				default:
-					ri.Error( ERR_DROP, "LoadTGA: illegal pixel_size '%d' in file '%s'\n", targa_header.pixel_size, name );
-					break;
+					pixbuf[0] = pixbuf[1] = pixbuf[2] = *buf_p++;
+					pixbuf[3] = 255;
+				}
+				break;
+			case 24:
+				for(column=0; column<columns; column++, pixbuf+=4, buf_p+=3) 
+				{
+					pixbuf[0] = buf_p[2];
+					pixbuf[1] = buf_p[1];
+					pixbuf[2] = buf_p[0];
+					pixbuf[3] = 255;
 				}
+				break;
+			case 32:
+				R_CopyBGRAToRGBA( buf_p, pixbuf, columns );
+				buf_p += columns*4;
+				break;
+			default:
+				ri.Error( ERR_DROP, "LoadTGA: illegal pixel_size '%d' in file '%s'\n", targa_header.pixel_size, name );
+				break;
 			}
 		}
 	}
 	else if (targa_header.image_type==10) {   // Runlength encoded RGB images
-		unsigned char red,green,blue,alphabyte,packetHeader,packetSize,j;
+		unsigned char red,green,blue,alphabyte,packetHeader;
+		int packetSize, count, j;
 
-		red = 0;
-		green = 0;
-		blue = 0;
-		alphabyte = 0xff;
+		if ( targa_header.pixel_size != 24 && targa_header.pixel_size != 32 ) {
+			ri.Error( ERR_DROP, "LoadTGA: illegal pixel_size '%d' in file '%s'\n", targa_header.pixel_size, name );
+		}
 
 		for(row=rows-1; row>=0; row--) {
 			pixbuf = targa_rgba + row*columns*4;
@@ -1343,75 +1371,55 @@ static void LoadTGA ( const char *name, byte **pic, int *width, int *height)
 				packetHeader= *buf_p++;
 				packetSize = 1 + (packetHeader & 0x7f);
 				if (packetHeader & 0x80) {        // run-length packet
-					switch (targa_header.pixel_size) {
-						case 24:
-								blue = *buf_p++;
-								green = *buf_p++;
-								red = *buf_p++;
-								alphabyte = 255;
-								break;
-						case 32:
-								blue = *buf_p++;
-								green = *buf_p++;
-								red = *buf_p++;
-								alphabyte = *buf_p++;
-								break;
-						default:
-							ri.Error( ERR_DROP, "LoadTGA: illegal pixel_size '%d' in file '%s'\n", targa_header.pixel_size, name );
-							break;
+					blue = *buf_p++;
+					green = *buf_p++;
+					red = *buf_p++;
+					alphabyte = 255;
+					if (targa_header.pixel_size == 32) {
+						alphabyte = *buf_p++;
 					}
-	
-					for(j=0;j<packetSize;j++) {
-						*pixbuf++=red;
-						*pixbuf++=green;
-						*pixbuf++=blue;
-						*pixbuf++=alphabyte;
-						column++;
-						if (column==columns) { // run spans across rows
-							column=0;
-							if (row>0)
-								row--;
-							else
-								goto breakOut;
-							pixbuf = targa_rgba + row*columns*4;
+				} else {
+					red = green = blue = alphabyte = 0;
+				}
+
+				// a packet may span across rows, process it in per-row pieces
+				while (packetSize > 0) {
+					count = columns - column;
+					if (count > packetSize) {
+						count = packetSize;
+					}
+
+					if (packetHeader & 0x80) {
+						for(j=0;j<count;j++, pixbuf+=4) {
+							pixbuf[0]=red;
+							pixbuf[1]=green;
+							pixbuf[2]=blue;
+							pixbuf[3]=alphabyte;
 						}
 					}
-				}
-				else {                            // non run-length packet
-					for(j=0;j<packetSize;j++) {
-						switch (targa_header.pixel_size) {
-							case 24:
-									blue = *buf_p++;
-									green = *buf_p++;
-									red = *buf_p++;
-									*pixbuf++ = red;
-									*pixbuf++ = green;
-									*pixbuf++ = blue;
-									*pixbuf++ = 255;
-									break;
-							case 32:
-									blue = *buf_p++;
-									green = *buf_p++;
-									red = *buf_p++;
-									alphabyte = *buf_p++;
-									*pixbuf++ = red;
-									*pixbuf++ = green;
-									*pixbuf++ = blue;
-									*pixbuf++ = alphabyte;
-									break;
-							default:
-								ri.Error( ERR_DROP, "LoadTGA: illegal pixel_size '%d' in file '%s'\n", targa_header.pixel_size, name );
-								break;
+					else if (targa_header.pixel_size == 32) {
+						R_CopyBGRAToRGBA( buf_p, pixbuf, count );
+						buf_p += count*4;
+						pixbuf += count*4;
+					}
+					else {
+						for(j=0;j<count;j++, pixbuf+=4, buf_p+=3) {
+							pixbuf[0] = buf_p[2];
+							pixbuf[1] = buf_p[1];
+							pixbuf[2] = buf_p[0];
+							pixbuf[3] = 255;
 						}
-						column++;
-						if (column==columns) { // pixel packet run spans across rows
-							column=0;
-							if (row>0)
-								row--;
-							else
-								goto breakOut;
-							pixbuf = targa_rgba + row*columns*4;
-						}						
+					}
+
+					packetSize -= count;
+					column += count;
+					if (column==columns) { // packet spans across rows
+						column=0;
+						if (row>0)
+							row--;
+						else
+							goto breakOut;
+						pixbuf = targa_rgba + row*columns*4;
 					}
 				}
 			}
@@ -1628,6 +1636,73 @@ image_t	*R_FindImageFile( const char *name, qboolean mipmap, qboolean allowPicmi
 }
 
 
+/*
+===============
+R_ImageBench_f
+
+Decodes every .tga and .jpg image in a directory and builds its mip chain,
+reporting the time spent in each stage. Nothing is uploaded to the GPU.
+===============
+*/
+void R_ImageBench_f( void ) {
+	const char	*exts[2] = { ".tga", ".jpg" };
+	const char	*dir;
+	char		**files;
+	char		name[MAX_QPATH];
+	int			numFiles;
+	int			i, e, start;
+	int			numImages, decodeMsec, mipMsec;
+	double		pixels;
+
+	if ( ri.Cmd_Argc() != 2 ) {
+		ri.Printf( PRINT_ALL, "usage: imagebench <directory>\n" );
+		return;
+	}
+	dir = ri.Cmd_Argv( 1 );
+
+	numImages = 0;
+	decodeMsec = 0;
+	mipMsec = 0;
+	pixels = 0;
+
+	for ( e = 0; e < 2; e++ ) {
+		files = ri.FS_ListFiles( dir, exts[e], &numFiles );
+		for ( i = 0; i < numFiles; i++ ) {
+			byte	*pic;
+			int		width, height;
+
+			Com_sprintf( name, sizeof( name ), "%s/%s", dir, files[i] );
+
+			start = ri.Milliseconds();
+			R_LoadImage( name, &pic, &width, &height );
+			decodeMsec += ri.Milliseconds() - start;
+			if ( !pic ) {
+				continue;
+			}
+
+			start = ri.Milliseconds();
+			Image_Upload_Data upload_data = generate_image_upload_data( pic, width, height, qtrue, qfalse );
+			mipMsec += ri.Milliseconds() - start;
+
+			ri.Hunk_FreeTempMemory( upload_data.buffer );
+			ri.Free( pic );
+
+			numImages++;
+			pixels += (double)width * height;
+		}
+		ri.FS_FreeFileList( files );
+	}
+
+	if ( !numImages ) {
+		ri.Printf( PRINT_ALL, "imagebench: no images found in %s\n", dir );
+		return;
+	}
+
+	ri.Printf( PRINT_ALL, "%i images, %.2f Mpixels\n", numImages, pixels / 1e6 );
+	ri.Printf( PRINT_ALL, "decode: %5i msec, %.1f Mpixels/sec\n", decodeMsec, pixels / 1e3 / ( decodeMsec ? decodeMsec : 1 ) );
+	ri.Printf( PRINT_ALL, "mipmap: %5i msec, %.1f Mpixels/sec\n", mipMsec, pixels / 1e3 / ( mipMsec ? mipMsec : 1 ) );
+}
+
 /*
 ================
 R_CreateDlightImage
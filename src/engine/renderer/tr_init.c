@@ -24,6 +24,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "tr_local.h"
 
 bool		gl_active;
+bool		null_active;
 glconfig_t	glConfig;
 glstate_t	glState;
 
@@ -185,6 +186,8 @@ RenderApi get_render_api() {
 #else
 		return RENDER_API_VK; // use default (Vulkan) if dx12 is disabled
 #endif
+	else if (r_renderAPI->integer == 3)
+		return RENDER_API_NULL;
 	else
 		return RENDER_API_VK; // use default (Vulkan) if invalid r_renderAPI value is specified
 }
@@ -213,33 +216,47 @@ static void InitRenderAPI( void )
 		}
 #endif
 
-		// OpenGL
-		if (get_render_api() == RENDER_API_GL || r_twinMode->integer)
+		// Null backend runs the front-end and tessellation without a rendering device.
+		// Twin mode is ignored since there is nothing to compare against.
+		if (get_render_api() == RENDER_API_NULL)
 		{
-			GLimp_Init();
+			null_imp_init();
+			null_active = true;
+		}
+		else
+		{
+			// OpenGL
+			if (get_render_api() == RENDER_API_GL || r_twinMode->integer)
+			{
+				GLimp_Init();
 
-			GLint temp;
-			qglGetIntegerv( GL_MAX_TEXTURE_SIZE, &temp );
-			glConfig.maxTextureSize = temp;
+				GLint temp;
+				qglGetIntegerv( GL_MAX_TEXTURE_SIZE, &temp );
+				glConfig.maxTextureSize = temp;
 
-			gl_active = true;
-		}
+				gl_active = true;
+			}
 
-		// VULKAN
-		if (get_render_api() == RENDER_API_VK || r_twinMode->integer)
-		{
-			vk_imp_init();
-			vk_initialize();
-		}
+			// VULKAN
+			if (get_render_api() == RENDER_API_VK || r_twinMode->integer)
+			{
+				vk_imp_init();
+				vk_initialize();
+			}
 
-		// DX12
+			// DX12
 #ifdef ENABLE_DX12
-		if (get_render_api() == RENDER_API_DX || r_twinMode->integer)
-		{
-			dx_imp_init();
-			dx_initialize();
-		}
+			if (get_render_api() == RENDER_API_DX || r_twinMode->integer)
+			{
+				dx_imp_init();
+				dx_initialize();
+			}
 #endif
+		}
+
+		// r_renderAPI can fall back, this is what actually came up
+		static const char *api_names[] = { "opengl", "vulkan", "dx12", "null" };
+		ri.Cvar_Set( "r_activeRenderAPI", api_names[get_render_api()] );
 	}
 
 	// init command buffers and SMP
@@ -883,6 +900,10 @@ void GfxInfo_f( void )
 		ri.Printf( PRINT_ALL, "\nActive 3D API: DirectX 12\n" );
 	}
 
+	if (null_active) {
+		ri.Printf( PRINT_ALL, "\nActive 3D API: null (no rendering device)\n" );
+	}
+
 	//
 	// Info that doesn't depend on r_renderAPI
 	//
@@ -916,6 +937,7 @@ void R_Register( void )
 	r_vsync = ri.Cvar_Get( "r_vsync", "0", CVAR_ARCHIVE | CVAR_LATCH );
 	r_shaderGamma = ri.Cvar_Get("r_shaderGamma", "0", CVAR_ARCHIVE);
 	r_twinMode = ri.Cvar_Get( "r_twinMode", "0", CVAR_LATCH );
+	ri.Cvar_Get( "r_activeRenderAPI", "", CVAR_ROM );
 
 	//
 	// latched and archived variables
@@ -1024,6 +1046,7 @@ void R_Register( void )
 	// make sure all the commands added here are also
 	// removed in R_Shutdown
 	ri.Cmd_AddCommand( "imagelist", R_ImageList_f );
+	ri.Cmd_AddCommand( "imagebench", R_ImageBench_f );
 	ri.Cmd_AddCommand( "shaderlist", R_ShaderList_f );
 	ri.Cmd_AddCommand( "skinlist", R_SkinList_f );
 	ri.Cmd_AddCommand( "modellist", R_Modellist_f );
@@ -1143,6 +1166,7 @@ void RE_Shutdown( qboolean destroyWindow ) {
 	ri.Cmd_RemoveCommand ("screenshotJPEG");
 	ri.Cmd_RemoveCommand ("screenshot");
 	ri.Cmd_RemoveCommand ("imagelist");
+	ri.Cmd_RemoveCommand ("imagebench");
 	ri.Cmd_RemoveCommand ("shaderlist");
 	ri.Cmd_RemoveCommand ("skinlist");
 	ri.Cmd_RemoveCommand ("gfxinfo");
@@ -1181,6 +1205,13 @@ void RE_Shutdown( qboolean destroyWindow ) {
 		}
 	}
 
+	if (null_active) {
+		if (destroyWindow) {
+			null_imp_shutdown();
+			null_active = false;
+		}
+	}
+
 	tr.registered = qfalse;
 }
 
@@ -571,6 +571,13 @@ typedef struct srfGridMesh_s {
 	int				lodFixed;
 	int				lodStitched;
 
+	// rows and columns picked by RB_SurfaceGrid, reused while the lod
+	// error stays in [lodErrorMin, lodErrorMax)
+	float			lodErrorMin, lodErrorMax;
+	int				lodWidth, lodHeight;
+	int				lodWidthTable[MAX_GRID_SIZE];
+	int				lodHeightTable[MAX_GRID_SIZE];
+
 	// vertexes
 	int				width, height;
 	float			*widthLodError;
@@ -651,7 +658,6 @@ typedef struct msurface_s {
 typedef struct mnode_s {
 	// common with leaf and node
 	int			contents;		// -1 for nodes, to differentiate from leafs
-	int			visframe;		// node needs to be traversed if current
 	vec3_t		mins, maxs;		// for bounding box culling
 	struct mnode_s	*parent;
 
@@ -697,6 +703,12 @@ typedef struct {
 	int			nummarksurfaces;
 	msurface_t	**marksurfaces;
 
+	// leafs marked by the last R_MarkLeaves, with the bounds kept in
+	// separate arrays so they can be frustum tested four at a time
+	int			numVisLeafs;
+	mnode_t		**visLeafs;
+	float		*visLeafBounds[6];	// mins x, y, z, then maxs x, y, z
+
 	int			numfogs;
 	fog_t		*fogs;
 
@@ -798,6 +810,7 @@ typedef struct {
 	int		c_leafs;
 	int		c_dlightSurfaces;
 	int		c_dlightSurfacesCulled;
+	int		c_dlightsCulled;		// whole lights outside the view frustum
 } frontEndCounters_t;
 
 #define	FOG_TABLE_SIZE		256
@@ -818,9 +831,16 @@ typedef struct {
 
 typedef struct {
 	int		c_surfaces, c_shaders, c_vertexes, c_indexes, c_totalIndexes;
-	
+	int		c_draws;		// one per submitted stage, matches pipeline binds in Vulkan/DX12
+	int		c_bytesStreamed;	// vertex and index data the backend has to upload
+
+	int		c_pipelineBinds, c_pipelineBindsSkipped;		// Vulkan only
+	int		c_descriptorBinds, c_descriptorBindsSkipped;	// Vulkan only
+
 	int		c_dlightVertexes;
 	int		c_dlightIndexes;
+	int		c_dlightDraws;
+	int		c_dlightsRejected;	// lights that miss the tess bounds entirely
 
 	int		msec;			// total msec for backend run
 } backEndCounters_t;
@@ -934,6 +954,7 @@ typedef struct {
 extern backEndState_t	backEnd;
 extern trGlobals_t	tr;
 extern bool			gl_active;		// set to true if OpenGL is used for rendering
+extern bool			null_active;	// set to true if the null backend is used (no rendering device)
 extern glconfig_t	glConfig;		// outside of TR since it shouldn't be cleared during ref re-init
 extern glstate_t	glState;		// outside of TR since it shouldn't be cleared during ref re-init
 
@@ -948,7 +969,8 @@ extern Dx_World		dx_world;		// this data is cleared during ref re-init
 enum RenderApi {
 	RENDER_API_GL,
 	RENDER_API_VK,
-	RENDER_API_DX
+	RENDER_API_DX,
+	RENDER_API_NULL
 };
 
 RenderApi get_render_api();
@@ -956,7 +978,7 @@ RenderApi get_render_api();
 //
 // cvars
 //
-extern cvar_t	*r_renderAPI;			// 3D API to use: 0 - OpenGL, 1 - Vulkan
+extern cvar_t	*r_renderAPI;			// 3D API to use: 0 - OpenGL, 1 - Vulkan, 2 - DX12, 3 - null (no rendering device)
 extern cvar_t	*r_gpu;					// Select GPU in multi-GPU system (zero-based index, only in Vulkan). By default, GPU 0 is selected.
 extern cvar_t	*r_vsync;				// Enable vsync in Vulkan (com_maxFPS may be set to 0)
 extern cvar_t	*r_shaderGamma;			// Use compute shader to apply gamma (only in Vulkan) instead of legacy HW gamma API.
@@ -1160,6 +1182,7 @@ void		R_SetColorMappings( void );
 void		R_GammaCorrect( byte *buffer, int bufSize );
 
 void	R_ImageList_f( void );
+void	R_ImageBench_f( void );
 void	R_SkinList_f( void );
 // https://zerowing.idsoftware.com/bugzilla/show_bug.cgi?id=516
 const void *RB_TakeScreenshotCmd( const void *data );
@@ -1214,6 +1237,9 @@ void vk_imp_create_surface();
 void dx_imp_init();
 void dx_imp_shutdown();
 
+void null_imp_init();
+void null_imp_shutdown();
+
 // NOTE TTimo linux works with float gamma value, not the gamma table
 //   the params won't be used, getting the r_gamma cvar directly
 void		GLimp_SetGamma( unsigned char mapping[256] );
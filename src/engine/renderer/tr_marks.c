@@ -125,6 +125,38 @@ static void R_ChopPolyBehindPlane( int numInPoints, vec3_t inPoints[MAX_VERTS_ON
 	}
 }
 
+/*
+=================
+R_PolyOutsideBounds
+
+Returns qtrue if the polygon can't reach the given box, which is
+much cheaper than finding out by chopping it
+=================
+*/
+static qboolean R_PolyOutsideBounds( int numPoints, vec3_t points[MAX_VERTS_ON_POLY], const vec3_t mins, const vec3_t maxs ) {
+	int		i, j;
+
+	for ( j = 0 ; j < 3 ; j++ ) {
+		for ( i = 0 ; i < numPoints ; i++ ) {
+			if ( points[i][j] >= mins[j] ) {
+				break;
+			}
+		}
+		if ( i == numPoints ) {
+			return qtrue;
+		}
+		for ( i = 0 ; i < numPoints ; i++ ) {
+			if ( points[i][j] <= maxs[j] ) {
+				break;
+			}
+		}
+		if ( i == numPoints ) {
+			return qtrue;
+		}
+	}
+	return qfalse;
+}
+
 /*
 =================
 R_BoxSurfaces_r
@@ -256,6 +288,7 @@ int R_MarkFragments( int numPoints, const vec3_t *points, const vec3_t projectio
 	int				i, j, k, m, n;
 	surfaceType_t	*surfaces[64];
 	vec3_t			mins, maxs;
+	vec3_t			clipMins, clipMaxs;
 	int				returnedFragments;
 	int				returnedPoints;
 	vec3_t			normals[MAX_VERTS_ON_POLY+2];
@@ -307,6 +340,26 @@ int R_MarkFragments( int numPoints, const vec3_t *points, const vec3_t projectio
 	dists[numPoints+1] = DotProduct(normals[numPoints+1], points[0]) - 20;
 	numPlanes = numPoints + 2;
 
+	// the bounding planes enclose the polygon swept along the projection
+	// between the near and far planes, so bound that volume as well to
+	// throw out triangles before chopping them
+	ClearBounds( clipMins, clipMaxs );
+	for ( i = 0 ; i < numPoints ; i++ ) {
+		vec3_t	temp;
+		float	d;
+
+		d = DotProduct( projectionDir, points[i] ) - DotProduct( projectionDir, points[0] );
+		VectorMA( points[i], -32 - d, projectionDir, temp );
+		AddPointToBounds( temp, clipMins, clipMaxs );
+		VectorMA( points[i], 20 - d, projectionDir, temp );
+		AddPointToBounds( temp, clipMins, clipMaxs );
+	}
+	for ( i = 0 ; i < 3 ; i++ ) {
+		// points within the chop epsilon of a plane are kept
+		clipMins[i] -= 1;
+		clipMaxs[i] += 1;
+	}
+
 	numsurfaces = 0;
 	R_BoxSurfaces_r(tr.world->nodes, mins, maxs, surfaces, 64, &numsurfaces, projectionDir);
 	//assert(numsurfaces <= 64);
@@ -320,6 +373,11 @@ int R_MarkFragments( int numPoints, const vec3_t *points, const vec3_t projectio
 		if (*surfaces[i] == SF_GRID) {
 
 			cv = (srfGridMesh_t *) surfaces[i];
+			if ( cv->meshBounds[0][0] > clipMaxs[0] || cv->meshBounds[1][0] < clipMins[0]
+				|| cv->meshBounds[0][1] > clipMaxs[1] || cv->meshBounds[1][1] < clipMins[1]
+				|| cv->meshBounds[0][2] > clipMaxs[2] || cv->meshBounds[1][2] < clipMins[2] ) {
+				continue;
+			}
 			for ( m = 0 ; m < cv->height - 1 ; m++ ) {
 				for ( n = 0 ; n < cv->width - 1 ; n++ ) {
 					// We triangulate the grid and chop all triangles within
@@ -358,7 +416,7 @@ int R_MarkFragments( int numPoints, const vec3_t *points, const vec3_t projectio
 					VectorSubtract(clipPoints[0][2], clipPoints[0][1], v2);
 					CrossProduct(v1, v2, normal);
 					VectorNormalizeFast(normal);
-					if (DotProduct(normal, projectionDir) < -0.1) {
+					if (DotProduct(normal, projectionDir) < -0.1 && !R_PolyOutsideBounds(3, clipPoints[0], clipMins, clipMaxs)) {
 						// add the fragments of this triangle
 						R_AddMarkFragments(numClipPoints, clipPoints,
 										   numPlanes, normals, dists,
@@ -382,7 +440,7 @@ int R_MarkFragments( int numPoints, const vec3_t *points, const vec3_t projectio
 					VectorSubtract(clipPoints[0][2], clipPoints[0][1], v2);
 					CrossProduct(v1, v2, normal);
 					VectorNormalizeFast(normal);
-					if (DotProduct(normal, projectionDir) < -0.05) {
+					if (DotProduct(normal, projectionDir) < -0.05 && !R_PolyOutsideBounds(3, clipPoints[0], clipMins, clipMaxs)) {
 						// add the fragments of this triangle
 						R_AddMarkFragments(numClipPoints, clipPoints,
 										   numPlanes, normals, dists,
@@ -418,6 +476,9 @@ int R_MarkFragments( int numPoints, const vec3_t *points, const vec3_t projectio
 					v = surf->points[0] + VERTEXSIZE * indexes[k+j];;
 					VectorMA( v, MARKER_OFFSET, surf->plane.normal, clipPoints[0][j] );
 				}
+				if ( R_PolyOutsideBounds( 3, clipPoints[0], clipMins, clipMaxs ) ) {
+					continue;
+				}
 				// add the fragments of this face
 				R_AddMarkFragments( 3 , clipPoints,
 								   numPlanes, normals, dists,
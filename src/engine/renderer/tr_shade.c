@@ -37,6 +37,12 @@ R_DrawElements
 */
 static void R_DrawElements( int numIndexes, const glIndex_t *indexes ) {
     qglDrawElements(GL_TRIANGLES, numIndexes, GL_INDEX_TYPE, indexes);
+
+	// every API draws once per R_DrawElements call, so this is where
+	// per-draw traffic is accounted regardless of the active backend
+	backEnd.pc.c_draws++;
+	backEnd.pc.c_bytesStreamed += numIndexes * (int)sizeof(glIndex_t) +
+		tess.numVertexes * (int)(sizeof(color4ub_t) + sizeof(vec2_t));
 }
 
 /*
@@ -300,11 +306,19 @@ static void ProjectDlightTexture( void ) {
 	float	radius;
 	vec3_t	floatColor;
 	float	modulate;
+	vec3_t	bounds[2];
 
 	if ( !backEnd.refdef.num_dlights ) {
 		return;
 	}
 
+	// the tess can hold many merged surfaces, so find out once what
+	// it covers and throw out lights that don't reach any of it
+	ClearBounds( bounds[0], bounds[1] );
+	for ( i = 0 ; i < tess.numVertexes ; i++ ) {
+		AddPointToBounds( tess.xyz[i], bounds[0], bounds[1] );
+	}
+
 	for ( l = 0 ; l < backEnd.refdef.num_dlights ; l++ ) {
 		dlight_t	*dl;
 
@@ -317,6 +331,13 @@ static void ProjectDlightTexture( void ) {
 		dl = &backEnd.refdef.dlights[l];
 		VectorCopy( dl->transformed, origin );
         radius = dl->radius;
+
+		if ( origin[0] - radius > bounds[1][0] || origin[0] + radius < bounds[0][0]
+			|| origin[1] - radius > bounds[1][1] || origin[1] + radius < bounds[0][1]
+			|| origin[2] - radius > bounds[1][2] || origin[2] + radius < bounds[0][2] ) {
+			backEnd.pc.c_dlightsRejected++;
+			continue;
+		}
 		scale = 1.0f / radius;
 
 		floatColor[0] = dl->color[0] * 255.0f;
@@ -406,6 +427,7 @@ static void ProjectDlightTexture( void ) {
 		R_DrawElements( numIndexes, hitIndexes );
 		backEnd.pc.c_totalIndexes += numIndexes;
 		backEnd.pc.c_dlightIndexes += numIndexes;
+		backEnd.pc.c_dlightDraws++;
 
 		// VULKAN
 		if (vk.active) {
@@ -1019,6 +1041,7 @@ void RB_EndSurface( void ) {
 	backEnd.pc.c_shaders++;
 	backEnd.pc.c_vertexes += tess.numVertexes;
 	backEnd.pc.c_indexes += tess.numIndexes;
+	backEnd.pc.c_bytesStreamed += tess.numVertexes * (int)sizeof(vec4_t);
 	backEnd.pc.c_totalIndexes += tess.numIndexes * tess.numPasses;
 
 	//
@@ -34,8 +34,15 @@ static	texModInfo_t	texMods[MAX_SHADER_STAGES][TR_MAX_TEXMODS];
 #define FILE_HASH_SIZE		1024
 static	shader_t*		hashTable[FILE_HASH_SIZE];
 
+// every shader label found in the scripts is indexed once at init, so
+// a lookup never has to re-tokenize the combined shader text
+typedef struct {
+	char	*name;
+	char	*text;		// points just past the label
+} shaderTextEntry_t;
+
 #define MAX_SHADERTEXT_HASH		2048
-static char **shaderTextHashTable[MAX_SHADERTEXT_HASH];
+static shaderTextEntry_t *shaderTextHashTable[MAX_SHADERTEXT_HASH];
 
 /*
 ================
@@ -2221,40 +2228,20 @@ If found, it will return a valid shader
 =====================
 */
 static char *FindShaderInShaderText( const char *shadername ) {
-
-	char *token, *p;
-
-	int i, hash;
+	shaderTextEntry_t *entry;
+	int hash;
 
 	hash = generateHashValue(shadername, MAX_SHADERTEXT_HASH);
 
-	for (i = 0; shaderTextHashTable[hash][i]; i++) {
-		p = shaderTextHashTable[hash][i];
-		token = COM_ParseExt(&p, qtrue);
-		if ( !Q_stricmp( token, shadername ) ) {
-			return p;
-		}
-	}
-
-	p = s_shaderText;
-
-	if ( !p ) {
+	if ( !shaderTextHashTable[hash] ) {
 		return NULL;
 	}
 
-	// look for label
-	while ( 1 ) {
-		token = COM_ParseExt( &p, qtrue );
-		if ( token[0] == 0 ) {
-			break;
-		}
-
-		if ( !Q_stricmp( token, shadername ) ) {
-			return p;
-		}
-		else {
-			// skip the definition
-			SkipBracedSection( &p );
+	// the index holds every label of the shader text in text order, so
+	// the first match is the same definition a linear scan would find
+	for (entry = shaderTextHashTable[hash]; entry->name; entry++) {
+		if ( !Q_stricmp( entry->name, shadername ) ) {
+			return entry->text;
 		}
 	}
 
@@ -2766,11 +2753,12 @@ static void ScanAndLoadShaderFiles( void )
 {
 	char **shaderFiles;
 	char *buffers[MAX_SHADER_FILES];
-	char *p;
+	char *p, *textEnd;
 	int numShaders;
 	int i;
-	char *oldp, *token, *hashMem;
-	int shaderTextHashTableSizes[MAX_SHADERTEXT_HASH], hash, size;
+	char *token, *hashMem, *nameMem;
+	int shaderTextHashTableSizes[MAX_SHADERTEXT_HASH], hash, size, nameSize;
+	shaderTextEntry_t *entry;
 
 	long sum = 0;
 	// scan for shader files
@@ -2801,83 +2789,71 @@ static void ScanAndLoadShaderFiles( void )
 
 	// build single large buffer
 	s_shaderText = (char*) ri.Hunk_Alloc( sum + numShaders*2, h_low );
+	textEnd = s_shaderText;
 
 	// free in reverse order, so the temp files are all dumped
 	for ( i = numShaders - 1; i >= 0 ; i-- ) {
-		strcat( s_shaderText, "\n" );
-		p = &s_shaderText[strlen(s_shaderText)];
-		strcat( s_shaderText, buffers[i] );
+		*textEnd++ = '\n';
+		p = textEnd;
+		strcpy( p, buffers[i] );
 		ri.FS_FreeFile( buffers[i] );
-		buffers[i] = p;
-		COM_Compress(p);
+		textEnd = p + COM_Compress(p);
 	}
+	*textEnd = 0;
 
 	// free up memory
 	ri.FS_FreeFileList( shaderFiles );
 
+	// count the labels that land in each hash bucket
 	Com_Memset(shaderTextHashTableSizes, 0, sizeof(shaderTextHashTableSizes));
 	size = 0;
-	//
-	for ( i = 0; i < numShaders; i++ ) {
-		// pointer to the first shader file
-		p = buffers[i];
-		// look for label
-		while ( 1 ) {
-			token = COM_ParseExt( &p, qtrue );
-			if ( token[0] == 0 ) {
-				break;
-			}
+	nameSize = 0;
 
-			hash = generateHashValue(token, MAX_SHADERTEXT_HASH);
-			shaderTextHashTableSizes[hash]++;
-			size++;
-			SkipBracedSection(&p);
-			// if we passed the pointer to the next shader file
-			if ( i < numShaders - 1 ) {
-				if ( p > buffers[i+1] ) {
-					break;
-				}
-			}
+	p = s_shaderText;
+	while ( 1 ) {
+		token = COM_ParseExt( &p, qtrue );
+		if ( token[0] == 0 ) {
+			break;
 		}
+
+		hash = generateHashValue(token, MAX_SHADERTEXT_HASH);
+		shaderTextHashTableSizes[hash]++;
+		size++;
+		nameSize += (int)strlen(token) + 1;
+		SkipBracedSection(&p);
 	}
 
 	size += MAX_SHADERTEXT_HASH;
 
-	hashMem = (char*) ri.Hunk_Alloc( size * sizeof(char *), h_low );
+	hashMem = (char*) ri.Hunk_Alloc( size * sizeof(shaderTextEntry_t) + nameSize, h_low );
+	nameMem = hashMem + size * sizeof(shaderTextEntry_t);
 
 	for (i = 0; i < MAX_SHADERTEXT_HASH; i++) {
-		shaderTextHashTable[i] = (char **) hashMem;
-		hashMem = ((char *) hashMem) + ((shaderTextHashTableSizes[i] + 1) * sizeof(char *));
+		shaderTextHashTable[i] = (shaderTextEntry_t *) hashMem;
+		hashMem = ((char *) hashMem) + ((shaderTextHashTableSizes[i] + 1) * sizeof(shaderTextEntry_t));
 	}
 
+	// fill the buckets in text order, each one is terminated by a zeroed entry
 	Com_Memset(shaderTextHashTableSizes, 0, sizeof(shaderTextHashTableSizes));
-	//
-	for ( i = 0; i < numShaders; i++ ) {
-		// pointer to the first shader file
-		p = buffers[i];
-		// look for label
-		while ( 1 ) {
-			oldp = p;
-			token = COM_ParseExt( &p, qtrue );
-			if ( token[0] == 0 ) {
-				break;
-			}
 
-			hash = generateHashValue(token, MAX_SHADERTEXT_HASH);
-			shaderTextHashTable[hash][shaderTextHashTableSizes[hash]++] = oldp;
-
-			SkipBracedSection(&p);
-			// if we passed the pointer to the next shader file
-			if ( i < numShaders - 1 ) {
-				if ( p > buffers[i+1] ) {
-					break;
-				}
-			}
+	p = s_shaderText;
+	while ( 1 ) {
+		token = COM_ParseExt( &p, qtrue );
+		if ( token[0] == 0 ) {
+			break;
 		}
-	}
 
-	return;
+		hash = generateHashValue(token, MAX_SHADERTEXT_HASH);
+		entry = &shaderTextHashTable[hash][shaderTextHashTableSizes[hash]++];
+		entry->name = nameMem;
+		entry->text = p;
+		strcpy( nameMem, token );
+		nameMem += strlen(token) + 1;
+
+		SkipBracedSection(&p);
+	}
 
+	ri.Printf( PRINT_DEVELOPER, "%i shader files, %i shader labels indexed\n", numShaders, size - MAX_SHADERTEXT_HASH );
 }
 
 
@@ -2936,6 +2912,8 @@ void R_InitShaders( void ) {
 	//ri.Printf( PRINT_ALL, "Initializing Shaders\n" );
 
 	Com_Memset(hashTable, 0, sizeof(hashTable));
+	Com_Memset(shaderTextHashTable, 0, sizeof(shaderTextHashTable));
+	s_shaderText = NULL;
 
 	CreateInternalShaders();
 
@@ -897,6 +897,63 @@ static float	LodErrorForVolume( vec3_t local, float radius ) {
 	return r_lodCurveError->value / d;
 }
 
+/*
+=============
+RB_GridLodTables
+
+Picks the rows and columns of the grid to emit for the given error.
+The choice only changes when the error crosses one of the row or
+column errors, so it is kept on the grid along with the range of
+errors it stays valid for.
+=============
+*/
+static void RB_GridLodTables( srfGridMesh_t *cv, float lodError ) {
+	int		i;
+	float	lodMin, lodMax;
+
+	if ( lodError >= cv->lodErrorMin && lodError < cv->lodErrorMax ) {
+		return;
+	}
+
+	lodMin = 0;
+	lodMax = 1e30f;
+
+	cv->lodWidthTable[0] = 0;
+	cv->lodWidth = 1;
+	for ( i = 1 ; i < cv->width-1 ; i++ ) {
+		if ( cv->widthLodError[i] <= lodError ) {
+			cv->lodWidthTable[cv->lodWidth] = i;
+			cv->lodWidth++;
+			if ( cv->widthLodError[i] > lodMin ) {
+				lodMin = cv->widthLodError[i];
+			}
+		} else if ( cv->widthLodError[i] < lodMax ) {
+			lodMax = cv->widthLodError[i];
+		}
+	}
+	cv->lodWidthTable[cv->lodWidth] = cv->width-1;
+	cv->lodWidth++;
+
+	cv->lodHeightTable[0] = 0;
+	cv->lodHeight = 1;
+	for ( i = 1 ; i < cv->height-1 ; i++ ) {
+		if ( cv->heightLodError[i] <= lodError ) {
+			cv->lodHeightTable[cv->lodHeight] = i;
+			cv->lodHeight++;
+			if ( cv->heightLodError[i] > lodMin ) {
+				lodMin = cv->heightLodError[i];
+			}
+		} else if ( cv->heightLodError[i] < lodMax ) {
+			lodMax = cv->heightLodError[i];
+		}
+	}
+	cv->lodHeightTable[cv->lodHeight] = cv->height-1;
+	cv->lodHeight++;
+
+	cv->lodErrorMin = lodMin;
+	cv->lodErrorMax = lodMax;
+}
+
 /*
 =============
 RB_SurfaceGrid
@@ -913,8 +970,8 @@ void RB_SurfaceGrid( srfGridMesh_t *cv ) {
 	drawVert_t	*dv;
 	int		rows, irows, vrows;
 	int		used;
-	int		widthTable[MAX_GRID_SIZE];
-	int		heightTable[MAX_GRID_SIZE];
+	const int	*widthTable;
+	const int	*heightTable;
 	float	lodError;
 	int		lodWidth, lodHeight;
 	int		numVertexes;
@@ -930,27 +987,11 @@ void RB_SurfaceGrid( srfGridMesh_t *cv ) {
 
 	// determine which rows and columns of the subdivision
 	// we are actually going to use
-	widthTable[0] = 0;
-	lodWidth = 1;
-	for ( i = 1 ; i < cv->width-1 ; i++ ) {
-		if ( cv->widthLodError[i] <= lodError ) {
-			widthTable[lodWidth] = i;
-			lodWidth++;
-		}
-	}
-	widthTable[lodWidth] = cv->width-1;
-	lodWidth++;
-
-	heightTable[0] = 0;
-	lodHeight = 1;
-	for ( i = 1 ; i < cv->height-1 ; i++ ) {
-		if ( cv->heightLodError[i] <= lodError ) {
-			heightTable[lodHeight] = i;
-			lodHeight++;
-		}
-	}
-	heightTable[lodHeight] = cv->height-1;
-	lodHeight++;
+	RB_GridLodTables( cv, lodError );
+	widthTable = cv->lodWidthTable;
+	heightTable = cv->lodHeightTable;
+	lodWidth = cv->lodWidth;
+	lodHeight = cv->lodHeight;
 
 
 	// very large grids may have more points or indexes than can be fit
@@ -20,6 +20,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 ===========================================================================
 */
 #include "tr_local.h"
+#include <xmmintrin.h> // SSE is always available on x64
 
 
 
@@ -215,10 +216,6 @@ static int R_DlightGrid( srfGridMesh_t *grid, int dlightBits ) {
 
 
 static int R_DlightTrisurf( srfTriangles_t *surf, int dlightBits ) {
-	// FIXME: more dlight culling to trisurfs...
-	surf->dlightBits[ tr.smpFrame ] = dlightBits;
-	return dlightBits;
-#if 0
 	int			i;
 	dlight_t	*dl;
 
@@ -227,12 +224,12 @@ static int R_DlightTrisurf( srfTriangles_t *surf, int dlightBits ) {
 			continue;
 		}
 		dl = &tr.refdef.dlights[i];
-		if ( dl->origin[0] - dl->radius > grid->meshBounds[1][0]
-			|| dl->origin[0] + dl->radius < grid->meshBounds[0][0]
-			|| dl->origin[1] - dl->radius > grid->meshBounds[1][1]
-			|| dl->origin[1] + dl->radius < grid->meshBounds[0][1]
-			|| dl->origin[2] - dl->radius > grid->meshBounds[1][2]
-			|| dl->origin[2] + dl->radius < grid->meshBounds[0][2] ) {
+		if ( dl->origin[0] - dl->radius > surf->bounds[1][0]
+			|| dl->origin[0] + dl->radius < surf->bounds[0][0]
+			|| dl->origin[1] - dl->radius > surf->bounds[1][1]
+			|| dl->origin[1] + dl->radius < surf->bounds[0][1]
+			|| dl->origin[2] - dl->radius > surf->bounds[1][2]
+			|| dl->origin[2] + dl->radius < surf->bounds[0][2] ) {
 			// dlight doesn't reach the bounds
 			dlightBits &= ~( 1 << i );
 		}
@@ -242,9 +239,8 @@ static int R_DlightTrisurf( srfTriangles_t *surf, int dlightBits ) {
 		tr.pc.c_dlightSurfacesCulled++;
 	}
 
-	grid->dlightBits[ tr.smpFrame ] = dlightBits;
+	surf->dlightBits[ tr.smpFrame ] = dlightBits;
 	return dlightBits;
-#endif
 }
 
 /*
@@ -350,149 +346,120 @@ void R_AddBrushModelSurfaces ( trRefEntity_t *ent ) {
 
 /*
 ================
-R_RecursiveWorldNode
+R_AddWorldLeaf
 ================
 */
-static void R_RecursiveWorldNode( mnode_t *node, int planeBits, int dlightBits ) {
-
-	do {
-		int			newDlights[2];
+static void R_AddWorldLeaf( mnode_t *leaf, int dlightBits ) {
+	int			c;
+	msurface_t	*surf, **mark;
 
-		// if the node wasn't marked as potentially visible, exit
-		if (node->visframe != tr.visCount) {
-			return;
-		}
-
-		// if the bounding volume is outside the frustum, nothing
-		// inside can be visible OPTIMIZE: don't do this all the way to leafs?
-
-		if ( !r_nocull->integer ) {
-			int		r;
+	tr.pc.c_leafs++;
 
-			if ( planeBits & 1 ) {
-				r = BoxOnPlaneSide(node->mins, node->maxs, &tr.viewParms.frustum[0]);
-				if (r == 2) {
-					return;						// culled
-				}
-				if ( r == 1 ) {
-					planeBits &= ~1;			// all descendants will also be in front
-				}
-			}
-
-			if ( planeBits & 2 ) {
-				r = BoxOnPlaneSide(node->mins, node->maxs, &tr.viewParms.frustum[1]);
-				if (r == 2) {
-					return;						// culled
-				}
-				if ( r == 1 ) {
-					planeBits &= ~2;			// all descendants will also be in front
-				}
-			}
+	// determine which dlights reach the leaf
+	if ( dlightBits ) {
+		int	i;
 
-			if ( planeBits & 4 ) {
-				r = BoxOnPlaneSide(node->mins, node->maxs, &tr.viewParms.frustum[2]);
-				if (r == 2) {
-					return;						// culled
-				}
-				if ( r == 1 ) {
-					planeBits &= ~4;			// all descendants will also be in front
-				}
-			}
+		for ( i = 0 ; i < tr.refdef.num_dlights ; i++ ) {
+			dlight_t	*dl;
 
-			if ( planeBits & 8 ) {
-				r = BoxOnPlaneSide(node->mins, node->maxs, &tr.viewParms.frustum[3]);
-				if (r == 2) {
-					return;						// culled
-				}
-				if ( r == 1 ) {
-					planeBits &= ~8;			// all descendants will also be in front
-				}
+			if ( !( dlightBits & ( 1 << i ) ) ) {
+				continue;
 			}
-
-		}
-
-		if ( node->contents != -1 ) {
-			break;
-		}
-
-		// node is just a decision point, so go down both sides
-		// since we don't care about sort orders, just go positive to negative
-
-		// determine which dlights are needed
-		newDlights[0] = 0;
-		newDlights[1] = 0;
-		if ( dlightBits ) {
-			int	i;
-
-			for ( i = 0 ; i < tr.refdef.num_dlights ; i++ ) {
-				dlight_t	*dl;
-				float		dist;
-
-				if ( dlightBits & ( 1 << i ) ) {
-					dl = &tr.refdef.dlights[i];
-					dist = DotProduct( dl->origin, node->plane->normal ) - node->plane->dist;
-					
-					if ( dist > -dl->radius ) {
-						newDlights[0] |= ( 1 << i );
-					}
-					if ( dist < dl->radius ) {
-						newDlights[1] |= ( 1 << i );
-					}
-				}
+			dl = &tr.refdef.dlights[i];
+			if ( dl->origin[0] - dl->radius > leaf->maxs[0]
+				|| dl->origin[0] + dl->radius < leaf->mins[0]
+				|| dl->origin[1] - dl->radius > leaf->maxs[1]
+				|| dl->origin[1] + dl->radius < leaf->mins[1]
+				|| dl->origin[2] - dl->radius > leaf->maxs[2]
+				|| dl->origin[2] + dl->radius < leaf->mins[2] ) {
+				dlightBits &= ~( 1 << i );
 			}
 		}
+	}
 
-		// recurse down the children, front side first
-		R_RecursiveWorldNode (node->children[0], planeBits, newDlights[0] );
+	// add to z buffer bounds
+	if ( leaf->mins[0] < tr.viewParms.visBounds[0][0] ) {
+		tr.viewParms.visBounds[0][0] = leaf->mins[0];
+	}
+	if ( leaf->mins[1] < tr.viewParms.visBounds[0][1] ) {
+		tr.viewParms.visBounds[0][1] = leaf->mins[1];
+	}
+	if ( leaf->mins[2] < tr.viewParms.visBounds[0][2] ) {
+		tr.viewParms.visBounds[0][2] = leaf->mins[2];
+	}
 
-		// tail recurse
-		node = node->children[1];
-		dlightBits = newDlights[1];
-	} while ( 1 );
+	if ( leaf->maxs[0] > tr.viewParms.visBounds[1][0] ) {
+		tr.viewParms.visBounds[1][0] = leaf->maxs[0];
+	}
+	if ( leaf->maxs[1] > tr.viewParms.visBounds[1][1] ) {
+		tr.viewParms.visBounds[1][1] = leaf->maxs[1];
+	}
+	if ( leaf->maxs[2] > tr.viewParms.visBounds[1][2] ) {
+		tr.viewParms.visBounds[1][2] = leaf->maxs[2];
+	}
 
-	{
-		// leaf node, so add mark surfaces
-		int			c;
-		msurface_t	*surf, **mark;
+	// add the individual surfaces
+	mark = leaf->firstmarksurface;
+	c = leaf->nummarksurfaces;
+	while (c--) {
+		// the surface may have already been added if it
+		// spans multiple leafs
+		surf = *mark;
+		R_AddWorldSurface( surf, dlightBits );
+		mark++;
+	}
+}
 
-		tr.pc.c_leafs++;
+/*
+================
+R_AddVisibleLeafs
 
-		// add to z buffer bounds
-		if ( node->mins[0] < tr.viewParms.visBounds[0][0] ) {
-			tr.viewParms.visBounds[0][0] = node->mins[0];
-		}
-		if ( node->mins[1] < tr.viewParms.visBounds[0][1] ) {
-			tr.viewParms.visBounds[0][1] = node->mins[1];
-		}
-		if ( node->mins[2] < tr.viewParms.visBounds[0][2] ) {
-			tr.viewParms.visBounds[0][2] = node->mins[2];
+Frustum culls the leaf list built by R_MarkLeaves, four leafs at a time.
+Only the box corner furthest along each plane normal has to be tested,
+and which corner that is depends on the plane alone.
+================
+*/
+static void R_AddVisibleLeafs( int dlightBits ) {
+	world_t		*w = tr.world;
+	__m128		normal[4][3];
+	__m128		dist[4];
+	const float	*corner[4][3];
+	int			i, j, k;
+	int			mask;
+
+	for ( j = 0 ; j < 4 ; j++ ) {
+		const cplane_t *frust = &tr.viewParms.frustum[j];
+
+		for ( k = 0 ; k < 3 ; k++ ) {
+			normal[j][k] = _mm_set1_ps( frust->normal[k] );
+			corner[j][k] = frust->normal[k] < 0 ? w->visLeafBounds[k] : w->visLeafBounds[3+k];
 		}
+		dist[j] = _mm_set1_ps( frust->dist );
+	}
 
-		if ( node->maxs[0] > tr.viewParms.visBounds[1][0] ) {
-			tr.viewParms.visBounds[1][0] = node->maxs[0];
+	for ( i = 0 ; i < w->numVisLeafs ; i += 4 ) {
+		mask = 15;
+		if ( w->numVisLeafs - i < 4 ) {
+			mask = ( 1 << ( w->numVisLeafs - i ) ) - 1;
 		}
-		if ( node->maxs[1] > tr.viewParms.visBounds[1][1] ) {
-			tr.viewParms.visBounds[1][1] = node->maxs[1];
-		}
-		if ( node->maxs[2] > tr.viewParms.visBounds[1][2] ) {
-			tr.viewParms.visBounds[1][2] = node->maxs[2];
+
+		if ( !r_nocull->integer ) {
+			for ( j = 0 ; j < 4 && mask ; j++ ) {
+				__m128 d = _mm_mul_ps( normal[j][0], _mm_loadu_ps( corner[j][0] + i ) );
+				d = _mm_add_ps( d, _mm_mul_ps( normal[j][1], _mm_loadu_ps( corner[j][1] + i ) ) );
+				d = _mm_add_ps( d, _mm_mul_ps( normal[j][2], _mm_loadu_ps( corner[j][2] + i ) ) );
+				mask &= _mm_movemask_ps( _mm_cmpge_ps( d, dist[j] ) );
+			}
 		}
 
-		// add the individual surfaces
-		mark = node->firstmarksurface;
-		c = node->nummarksurfaces;
-		while (c--) {
-			// the surface may have already been added if it
-			// spans multiple leafs
-			surf = *mark;
-			R_AddWorldSurface( surf, dlightBits );
-			mark++;
+		for ( k = 0 ; mask ; k++, mask >>= 1 ) {
+			if ( mask & 1 ) {
+				R_AddWorldLeaf( w->visLeafs[i + k], dlightBits );
+			}
 		}
 	}
-
 }
 
-
 /*
 ===============
 R_PointInLeaf
@@ -556,6 +523,23 @@ qboolean R_inPVS( const vec3_t p1, const vec3_t p2 ) {
 	return qtrue;
 }
 
+/*
+===============
+R_AddLeafToVisList
+===============
+*/
+static void R_AddLeafToVisList( mnode_t *leaf ) {
+	world_t	*w = tr.world;
+	int		n = w->numVisLeafs++;
+	int		j;
+
+	w->visLeafs[n] = leaf;
+	for ( j = 0 ; j < 3 ; j++ ) {
+		w->visLeafBounds[j][n] = leaf->mins[j];
+		w->visLeafBounds[3+j][n] = leaf->maxs[j];
+	}
+}
+
 /*
 ===============
 R_MarkLeaves
@@ -566,7 +550,7 @@ cluster
 */
 static void R_MarkLeaves (void) {
 	const byte	*vis;
-	mnode_t	*leaf, *parent;
+	mnode_t	*leaf;
 	int		i;
 	int		cluster;
 
@@ -598,11 +582,12 @@ static void R_MarkLeaves (void) {
 
 	tr.visCount++;
 	tr.viewCluster = cluster;
+	tr.world->numVisLeafs = 0;
 
 	if ( r_novis->integer || tr.viewCluster == -1 ) {
-		for (i=0 ; i<tr.world->numnodes ; i++) {
+		for (i=tr.world->numDecisionNodes ; i<tr.world->numnodes ; i++) {
 			if (tr.world->nodes[i].contents != CONTENTS_SOLID) {
-				tr.world->nodes[i].visframe = tr.visCount;
+				R_AddLeafToVisList( &tr.world->nodes[i] );
 			}
 		}
 		return;
@@ -610,7 +595,7 @@ static void R_MarkLeaves (void) {
 
 	vis = R_ClusterPVS (tr.viewCluster);
 	
-	for (i=0,leaf=tr.world->nodes ; i<tr.world->numnodes ; i++, leaf++) {
+	for (i=tr.world->numDecisionNodes,leaf=tr.world->nodes+i ; i<tr.world->numnodes ; i++, leaf++) {
 		cluster = leaf->cluster;
 		if ( cluster < 0 || cluster >= tr.world->numClusters ) {
 			continue;
@@ -626,17 +611,45 @@ static void R_MarkLeaves (void) {
 			continue;		// not visible
 		}
 
-		parent = leaf;
-		do {
-			if (parent->visframe == tr.visCount)
-				break;
-			parent->visframe = tr.visCount;
-			parent = parent->parent;
-		} while (parent);
+		R_AddLeafToVisList( leaf );
 	}
 }
 
 
+/*
+=============
+R_CullDlights
+
+Builds the list of dlights that can touch anything in the view, so
+the node walk and the per-surface tests only consider those.
+=============
+*/
+static int R_CullDlights( void ) {
+	int			i, j;
+	int			dlightBits;
+	dlight_t	*dl;
+
+	dlightBits = 0;
+	for ( i = 0 ; i < tr.refdef.num_dlights ; i++ ) {
+		dl = &tr.refdef.dlights[i];
+		if ( !r_nocull->integer ) {
+			for ( j = 0 ; j < 4 ; j++ ) {
+				cplane_t *frust = &tr.viewParms.frustum[j];
+				if ( DotProduct( dl->origin, frust->normal ) - frust->dist < -dl->radius ) {
+					break;
+				}
+			}
+			if ( j != 4 ) {
+				// the whole light sphere is outside the view
+				tr.pc.c_dlightsCulled++;
+				continue;
+			}
+		}
+		dlightBits |= ( 1 << i );
+	}
+	return dlightBits;
+}
+
 /*
 =============
 R_AddWorldSurfaces
@@ -664,5 +677,5 @@ void R_AddWorldSurfaces (void) {
 	if ( tr.refdef.num_dlights > 32 ) {
 		tr.refdef.num_dlights = 32 ;
 	}
-	R_RecursiveWorldNode( tr.world->nodes, 15, ( 1 << tr.refdef.num_dlights ) - 1 );
+	R_AddVisibleLeafs( R_CullDlights() );
 }
@@ -904,6 +904,10 @@ void vk_initialize() {
 		alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
 		alloc_info.commandBufferCount = 1;
 		VK_CHECK(vkAllocateCommandBuffers(vk.device, &alloc_info, &vk.command_buffer));
+		VK_CHECK(vkAllocateCommandBuffers(vk.device, &alloc_info, &vk.upload_command_buffer));
+
+		VkFenceCreateInfo fence_desc{ VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+		VK_CHECK(vkCreateFence(vk.device, &fence_desc, nullptr, &vk.upload_fence));
 	}
 
 	//
@@ -1404,6 +1408,7 @@ void vk_shutdown() {
 	vkFreeMemory(vk.device, vk.gamma_buffer_memory, nullptr);
 	vkDestroySemaphore(vk.device, vk.image_acquired, nullptr);
 	vkDestroyFence(vk.device, vk.rendering_finished_fence, nullptr);
+	vkDestroyFence(vk.device, vk.upload_fence, nullptr);
 
 	vkDestroyShaderModule(vk.device, vk.single_texture_vs, nullptr);
 	vkDestroyShaderModule(vk.device, vk.single_texture_clipping_plane_vs, nullptr);
@@ -1448,6 +1453,7 @@ void vk_shutdown() {
 }
 
 void vk_release_resources() {
+	vk_flush_image_uploads();
 	vkDeviceWaitIdle(vk.device);
 
 	for (int i = 0; i < vk_world.num_image_chunks; i++)
@@ -1575,20 +1581,56 @@ void vk_upload_image_data(VkImage image, int width, int height, bool mipmap, con
 		if (height < 1) height = 1;
 	}
 
-	ensure_staging_buffer_allocation(buffer_size);
-	Com_Memcpy(vk_world.staging_buffer_ptr, pixels, buffer_size);
+	// Append image data to the staging buffer. If the current batch does not have enough
+	// space then submit it first, so the whole staging buffer becomes available again.
+	VkDeviceSize offset = (vk_world.staging_buffer_offset + 15) & ~(VkDeviceSize)15;
 
-	record_and_run_commands(vk.command_pool, vk.queue,
-		[&image, &num_regions, &regions](VkCommandBuffer command_buffer) {
+	if (offset + buffer_size > vk_world.staging_buffer_size) {
+		vk_flush_image_uploads();
+		offset = 0;
+		ensure_staging_buffer_allocation(std::max(buffer_size, UPLOAD_BATCH_SIZE));
+	}
 
-		record_image_layout_transition(command_buffer, image, VK_IMAGE_ASPECT_COLOR_BIT,
-			0, VK_IMAGE_LAYOUT_UNDEFINED, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	Com_Memcpy(vk_world.staging_buffer_ptr + offset, pixels, buffer_size);
+	vk_world.staging_buffer_offset = offset + buffer_size;
 
-		vkCmdCopyBufferToImage(command_buffer, vk_world.staging_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, num_regions, regions);
+	for (int i = 0; i < num_regions; i++)
+		regions[i].bufferOffset += offset;
 
-		record_image_layout_transition(command_buffer, image, VK_IMAGE_ASPECT_COLOR_BIT,
-			VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-	});
+	if (vk_world.pending_uploads == 0) {
+		VkCommandBufferBeginInfo begin_info{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+		begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		VK_CHECK(vkBeginCommandBuffer(vk.upload_command_buffer, &begin_info));
+	}
+	vk_world.pending_uploads++;
+
+	record_image_layout_transition(vk.upload_command_buffer, image, VK_IMAGE_ASPECT_COLOR_BIT,
+		0, VK_IMAGE_LAYOUT_UNDEFINED, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+	vkCmdCopyBufferToImage(vk.upload_command_buffer, vk_world.staging_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, num_regions, regions);
+
+	record_image_layout_transition(vk.upload_command_buffer, image, VK_IMAGE_ASPECT_COLOR_BIT,
+		VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+void vk_flush_image_uploads() {
+	if (vk_world.pending_uploads == 0)
+		return;
+
+	VK_CHECK(vkEndCommandBuffer(vk.upload_command_buffer));
+
+	// Submission order guarantees that the copies are complete before any later
+	// frame command buffer samples the images, the fence only protects the staging buffer.
+	VkSubmitInfo submit_info{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+	submit_info.commandBufferCount = 1;
+	submit_info.pCommandBuffers = &vk.upload_command_buffer;
+	VK_CHECK(vkQueueSubmit(vk.queue, 1, &submit_info, vk.upload_fence));
+
+	VK_CHECK(vkWaitForFences(vk.device, 1, &vk.upload_fence, VK_FALSE, UINT64_MAX));
+	VK_CHECK(vkResetFences(vk.device, 1, &vk.upload_fence));
+
+	vk_world.pending_uploads = 0;
+	vk_world.staging_buffer_offset = 0;
 }
 
 void vk_update_descriptor_set(VkDescriptorSet set, VkImageView image_view, bool mipmap, bool repeat_texture) {
@@ -2334,22 +2376,50 @@ void vk_shade_geometry(VkPipeline pipeline, bool multitexture, Vk_Depth_Range de
 	vkCmdBindVertexBuffers(vk.command_buffer, 1, multitexture ? 3 : 2, bufs, offs);
 	vk.color_st_elements += tess.numVertexes;
 
-	// bind descriptor sets
+	// bind descriptor sets, starting from the first one that differs from the bound state.
+	// All pipelines share the same layout, so sets that are not rebound stay valid.
 	uint32_t set_count = multitexture ? 2 : 1;
-	vkCmdBindDescriptorSets(vk.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vk.pipeline_layout, 0, set_count, vk_world.current_descriptor_sets, 0, nullptr);
+	uint32_t first_set = 0;
+	while (first_set < set_count && vk_world.bound_descriptor_sets[first_set] == vk_world.current_descriptor_sets[first_set])
+		first_set++;
+
+	if (first_set < set_count) {
+		vkCmdBindDescriptorSets(vk.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vk.pipeline_layout, first_set, set_count - first_set, &vk_world.current_descriptor_sets[first_set], 0, nullptr);
+		for (uint32_t i = first_set; i < set_count; i++)
+			vk_world.bound_descriptor_sets[i] = vk_world.current_descriptor_sets[i];
+		backEnd.pc.c_descriptorBinds++;
+	} else {
+		backEnd.pc.c_descriptorBindsSkipped++;
+	}
 
 	// bind pipeline
-	vkCmdBindPipeline(vk.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+	if (pipeline != vk_world.bound_pipeline) {
+		vkCmdBindPipeline(vk.command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+		vk_world.bound_pipeline = pipeline;
+		backEnd.pc.c_pipelineBinds++;
+	} else {
+		backEnd.pc.c_pipelineBindsSkipped++;
+	}
 
 	// configure pipeline's dynamic state
 	VkRect2D scissor_rect = get_scissor_rect();
-	vkCmdSetScissor(vk.command_buffer, 0, 1, &scissor_rect);
+	if (memcmp(&scissor_rect, &vk_world.bound_scissor, sizeof(VkRect2D)) != 0) {
+		vkCmdSetScissor(vk.command_buffer, 0, 1, &scissor_rect);
+		vk_world.bound_scissor = scissor_rect;
+	}
 
 	VkViewport viewport = get_viewport(depth_range);
-	vkCmdSetViewport(vk.command_buffer, 0, 1, &viewport);
+	if (memcmp(&viewport, &vk_world.bound_viewport, sizeof(VkViewport)) != 0) {
+		vkCmdSetViewport(vk.command_buffer, 0, 1, &viewport);
+		vk_world.bound_viewport = viewport;
+	}
 
 	if (tess.shader->polygonOffset) {
-		vkCmdSetDepthBias(vk.command_buffer, r_offsetUnits->value, 0.0f, r_offsetFactor->value);
+		if (vk_world.bound_depth_bias[0] != r_offsetUnits->value || vk_world.bound_depth_bias[1] != r_offsetFactor->value) {
+			vkCmdSetDepthBias(vk.command_buffer, r_offsetUnits->value, 0.0f, r_offsetFactor->value);
+			vk_world.bound_depth_bias[0] = r_offsetUnits->value;
+			vk_world.bound_depth_bias[1] = r_offsetFactor->value;
+		}
 	}
 
 	// issue draw call
@@ -2365,6 +2435,9 @@ void vk_begin_frame() {
 	if (!vk.active)
 		return;
 
+	// images created since the last frame (e.g. during level loading) should be ready for sampling
+	vk_flush_image_uploads();
+
 	VK_CHECK(vkWaitForFences(vk.device, 1, &vk.rendering_finished_fence, VK_FALSE, 1e9));
 	VK_CHECK(vkResetFences(vk.device, 1, &vk.rendering_finished_fence));
 	VK_CHECK(vkAcquireNextImageKHR(vk.device, vk.swapchain, UINT64_MAX, vk.image_acquired, VK_NULL_HANDLE, &vk.swapchain_image_index));
@@ -2406,12 +2479,24 @@ void vk_begin_frame() {
 	vk.xyz_elements = 0;
 	vk.color_st_elements = 0;
 	vk.index_buffer_offset = 0;
+
+	// new command buffer, nothing is bound yet
+	vk_world.bound_pipeline = VK_NULL_HANDLE;
+	vk_world.bound_descriptor_sets[0] = VK_NULL_HANDLE;
+	vk_world.bound_descriptor_sets[1] = VK_NULL_HANDLE;
+	Com_Memset(&vk_world.bound_scissor, 0, sizeof(vk_world.bound_scissor));
+	Com_Memset(&vk_world.bound_viewport, 0, sizeof(vk_world.bound_viewport));
+	vk_world.bound_depth_bias[0] = -1e9f;
+	vk_world.bound_depth_bias[1] = -1e9f;
 }
 
 void vk_end_frame() {
 	if (!vk.active)
 		return;
 
+	// submit uploads made while recording this frame (cinematics) ahead of the frame itself
+	vk_flush_image_uploads();
+
 	vkCmdEndRenderPass(vk.command_buffer);
 
 	record_image_layout_transition(vk.command_buffer, vk.swapchain_images[vk.swapchain_image_index], VK_IMAGE_ASPECT_COLOR_BIT,
@@ -2586,6 +2671,7 @@ void vk_read_pixels(byte* buffer) {
 }
 
 void vk_update_gamma_buffer(float gamma_table[256]) {
+	vk_flush_image_uploads(); // staging buffer is about to be reused
 	vkDeviceWaitIdle(vk.device);
 	ensure_staging_buffer_allocation(256 * sizeof(float));
 	Com_Memcpy(vk_world.staging_buffer_ptr, gamma_table, 256 * sizeof(float));
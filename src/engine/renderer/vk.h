@@ -16,6 +16,10 @@ const int MAX_VK_IMAGES = 2048; // should be the same as MAX_DRAWIMAGES
 const int IMAGE_CHUNK_SIZE = 32 * 1024 * 1024;
 const int MAX_IMAGE_CHUNKS = 16;
 
+// Minimum staging buffer size. Image uploads are accumulated in the staging buffer
+// and submitted together, so it bounds the amount of data in a single upload batch.
+const int UPLOAD_BATCH_SIZE = 16 * 1024 * 1024;
+
 #define VK_CHECK(function_call) { \
 	VkResult result = function_call; \
 	if (result < 0) \
@@ -88,6 +92,7 @@ void vk_release_resources();
 //
 Vk_Image vk_create_image(int width, int height, VkFormat format, int mip_levels, bool repeat_texture);
 void vk_upload_image_data(VkImage image, int width, int height, bool mipmap, const uint8_t* pixels, int bytes_per_pixel);
+void vk_flush_image_uploads(); // submits pending image uploads and waits for their completion
 void vk_update_descriptor_set(VkDescriptorSet set, VkImageView image_view, bool mipmap, bool repeat_texture);
 VkSampler vk_find_sampler(const Vk_Sampler_Def& def);
 VkPipeline vk_find_pipeline(const Vk_Pipeline_Def& def);
@@ -131,6 +136,10 @@ struct Vk_Instance {
 	VkCommandPool command_pool = VK_NULL_HANDLE;
 	VkCommandBuffer command_buffer = VK_NULL_HANDLE;
 
+	// Image uploads are recorded into a separate command buffer and submitted in batches.
+	VkCommandBuffer upload_command_buffer = VK_NULL_HANDLE;
+	VkFence upload_fence = VK_NULL_HANDLE;
+
 	VkImage output_image = VK_NULL_HANDLE;
 	VkDeviceMemory output_image_memory = VK_NULL_HANDLE;
 	VkImageView output_image_view = VK_NULL_HANDLE;
@@ -243,6 +252,8 @@ struct Vk_World {
 	VkDeviceMemory staging_buffer_memory = VK_NULL_HANDLE;
 	VkDeviceSize staging_buffer_size = 0;
 	byte* staging_buffer_ptr = nullptr; // pointer to mapped staging buffer
+	VkDeviceSize staging_buffer_offset = 0; // staging memory used by the pending upload batch
+	int pending_uploads = 0; // number of image uploads recorded but not submitted yet
 
 	//
 	// State.
@@ -257,6 +268,14 @@ struct Vk_World {
 	bool dirty_depth_attachment;
 
 	float modelview_transform[16];
+
+	// Graphics state last recorded into the frame's command buffer. Consecutive stages
+	// often share it, so vk_shade_geometry uses it to skip redundant binds.
+	VkPipeline bound_pipeline;
+	VkDescriptorSet bound_descriptor_sets[2];
+	VkRect2D bound_scissor;
+	VkViewport bound_viewport;
+	float bound_depth_bias[2]; // constant factor, slope factor
 };
 
 // Most of the renderer's code uses Vulkan API via function provides in this file but 
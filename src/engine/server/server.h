@@ -106,6 +106,18 @@ typedef enum {
 	CS_ACTIVE		// client is fully in game
 } clientState_t;
 
+// where a client's entity was at the end of a game frame, for SV_TraceAtTime
+#define	MAX_POSITION_HISTORY	64		// power of two, 3.2 seconds at sv_fps 20
+
+typedef struct {
+	int				time;				// svs.time of the frame
+	vec3_t			origin;
+	vec3_t			mins, maxs;
+	int				contents;			// 0 if it wasn't linked
+	int				teleportBit;		// EF_TELEPORT_BIT, toggles when the origin jumps
+	qboolean		capsule;
+} clientPosition_t;
+
 typedef struct netchan_buffer_s {
 	msg_t           msg;
 	byte            msgBuffer[MAX_MSGLEN];
@@ -156,6 +168,9 @@ typedef struct client_s {
 	int				ping;
 	int				rate;				// bytes / second
 	int				snapshotMsec;		// requests a snapshot every snapshotMsec unless rate choked
+	byte			entityDeferrals[MAX_GENTITIES];	// snapshots in a row an entity's update was held back
+	clientPosition_t	positionHistory[MAX_POSITION_HISTORY];
+	int				numPositions;		// total recorded, the ring index is numPositions & (MAX_POSITION_HISTORY-1)
 	int				pureAuthentic;
 	qboolean  gotCP; // TTimo - additional flag to distinguish between a bad pure checksum, and no cp command at all
 	netchan_t		netchan;
@@ -223,6 +238,8 @@ extern	cvar_t	*sv_zombietime;
 extern	cvar_t	*sv_rconPassword;
 extern	cvar_t	*sv_privatePassword;
 extern	cvar_t	*sv_allowDownload;
+extern	cvar_t	*sv_httpPort;
+extern	cvar_t	*sv_dlURL;
 extern	cvar_t	*sv_maxclients;
 
 extern	cvar_t	*sv_privateClients;
@@ -243,6 +260,10 @@ extern	cvar_t	*sv_pure;
 extern	cvar_t	*sv_floodProtect;
 extern	cvar_t	*sv_lanForceRate;
 extern	cvar_t	*sv_strictAuth;
+extern	cvar_t	*sv_snapshotPriority;
+extern	cvar_t	*sv_antilagMaxMsec;
+extern	cvar_t	*sv_autoRecord;
+extern	cvar_t	*sv_demoKeyframe;
 
 //===========================================================
 
@@ -312,6 +333,16 @@ void SV_SendMessageToClient( msg_t *msg, client_t *client );
 void SV_SendClientMessages( void );
 void SV_SendClientSnapshot( client_t *client );
 
+//
+// sv_demo.c
+//
+void SV_DemoFrame( void );
+void SV_DemoStop( void );
+void SV_DemoAutoRecord( void );
+void SV_DemoConfigstringModified( int index );
+void SV_Record_f( void );
+void SV_StopRecord_f( void );
+
 //
 // sv_game.c
 //
@@ -395,6 +426,13 @@ void SV_Trace( trace_t *results, const vec3_t start, vec3_t mins, vec3_t maxs, c
 void SV_ClipToEntity( trace_t *trace, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int entityNum, int contentmask, int capsule );
 // clip to a specific entity
 
+void SV_TraceAtTime( trace_t *results, const vec3_t start, vec3_t mins, vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, int capsule, int time );
+// like SV_Trace, but the clients are where they were at time, which is
+// clamped to the last sv_antilagMaxMsec
+
+void SV_RecordPositionHistory( void );
+// called after every game frame
+
 //
 // sv_net_chan.c
 //
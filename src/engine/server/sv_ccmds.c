@@ -298,6 +298,9 @@ static void SV_MapRestart_f( void ) {
 		// add the map_restart command
 		SV_AddServerCommand( client, "map_restart\n" );
 
+		// the entities are all spawned again
+		Com_Memset( client->entityDeferrals, 0, sizeof( client->entityDeferrals ) );
+
 		// connect the client again, without the firstTime flag
 		denied = (char*) VM_ExplicitArgPtr( gvm, VM_Call( gvm, GAME_CLIENT_CONNECT, i, qfalse, isBot ) );
 		if ( denied ) {
@@ -733,6 +736,8 @@ void SV_AddOperatorCommands( void ) {
 	Cmd_AddCommand ("spdevmap", SV_Map_f);
 #endif
 	Cmd_AddCommand ("killserver", SV_KillServer_f);
+	Cmd_AddCommand ("sv_record", SV_Record_f);
+	Cmd_AddCommand ("sv_stoprecord", SV_StopRecord_f);
 	if( com_dedicated->integer ) {
 		Cmd_AddCommand ("say", SV_ConSay_f);
 	}
@@ -756,6 +761,8 @@ void SV_RemoveOperatorCommands( void ) {
 	Cmd_RemoveCommand ("dumpuser");
 	Cmd_RemoveCommand ("map_restart");
 	Cmd_RemoveCommand ("sectorlist");
+	Cmd_RemoveCommand ("sv_record");
+	Cmd_RemoveCommand ("sv_stoprecord");
 	Cmd_RemoveCommand ("say");
 #endif
 }
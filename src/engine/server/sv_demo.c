@@ -0,0 +1,362 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+
+#include "server.h"
+
+/*
+===============================================================================
+
+SERVER SIDE DEMO RECORDING
+
+A server demo is one master stream of the whole game rather than one
+client's view: every frame holds all the entities that would be sent to
+any client, every active client's playerState and any configstrings that
+changed. Any client's point of view can be cut out of it afterwards by
+applying the PVS the same way SV_BuildClientSnapshot does.
+
+File layout, all integers little endian:
+
+  header	"SVDM", version, sv_fps, sv_maxclients, keyframe msec,
+			mapname[MAX_QPATH]
+  frames	int length, then a huffman coded message:
+				long	serverTime
+				byte	flags (SVDEMO_KEYFRAME)
+				short index, bigstring value ... short MAX_CONFIGSTRINGS
+				byte clientNum, delta playerState ... byte MAX_CLIENTS
+				delta entities ... (MAX_GENTITIES-1 in GENTITYNUM_BITS)
+  index		{ int serverTime, int file offset } for each keyframe
+  trailer	int numKeyframes, int index offset, "SVDX"
+
+A keyframe is delta coded from nothing and carries every configstring,
+so playback can start at any keyframe. Keyframes are a fixed time apart,
+so the index entry for a time is found without searching.
+
+===============================================================================
+*/
+
+#define	SVDEMO_VERSION			1
+#define	SVDEMO_KEYFRAME			1
+#define	MAX_DEMO_KEYFRAMES		8192
+#define	MAX_DEMO_MSGLEN			(MAX_MSGLEN*16)
+
+typedef struct {
+	int				serverTime;
+	int				offset;
+} demoKeyframe_t;
+
+typedef struct {
+	fileHandle_t	file;
+	char			name[MAX_QPATH];
+	int				fileSize;
+	int				lastTime;
+	int				nextKeyframeTime;
+	int				keyframeMsec;
+
+	// what the last frame held, the next one is delta coded from it
+	entityState_t	entities[MAX_GENTITIES];
+	byte			entityValid[MAX_GENTITIES];
+	int				numEntities;
+	playerState_t	players[MAX_CLIENTS];
+	byte			playerValid[MAX_CLIENTS];
+
+	byte			configstringModified[MAX_CONFIGSTRINGS];
+
+	demoKeyframe_t	keyframes[MAX_DEMO_KEYFRAMES];
+	int				numKeyframes;
+} serverDemo_t;
+
+static serverDemo_t	svDemo;
+static byte			svDemoMsgBuf[MAX_DEMO_MSGLEN];
+
+/*
+==================
+SV_DemoWrite
+==================
+*/
+static void SV_DemoWrite( const void *data, int len ) {
+	FS_Write( data, len, svDemo.file );
+	svDemo.fileSize += len;
+}
+
+static void SV_DemoWriteLong( int v ) {
+	v = LittleLong( v );
+	SV_DemoWrite( &v, 4 );
+}
+
+/*
+==================
+SV_DemoStop
+
+Writes the keyframe index and closes the file
+==================
+*/
+void SV_DemoStop( void ) {
+	int		i;
+	int		indexOffset;
+
+	if ( !svDemo.file ) {
+		return;
+	}
+
+	indexOffset = svDemo.fileSize;
+	for ( i = 0 ; i < svDemo.numKeyframes ; i++ ) {
+		SV_DemoWriteLong( svDemo.keyframes[i].serverTime );
+		SV_DemoWriteLong( svDemo.keyframes[i].offset );
+	}
+	SV_DemoWriteLong( svDemo.numKeyframes );
+	SV_DemoWriteLong( indexOffset );
+	SV_DemoWrite( "SVDX", 4 );
+
+	FS_FCloseFile( svDemo.file );
+	svDemo.file = 0;
+
+	Com_Printf( "Stopped server demo %s, %i KB, %i keyframes\n", svDemo.name,
+		svDemo.fileSize >> 10, svDemo.numKeyframes );
+}
+
+/*
+==================
+SV_DemoStart
+==================
+*/
+static void SV_DemoStart( const char *name ) {
+	char	mapname[MAX_QPATH];
+
+	SV_DemoStop();
+
+	Com_sprintf( svDemo.name, sizeof( svDemo.name ), "svdemos/%s.svdm", name );
+	svDemo.file = FS_FOpenFileWrite( svDemo.name );
+	if ( !svDemo.file ) {
+		Com_Printf( "ERROR: couldn't open %s\n", svDemo.name );
+		return;
+	}
+
+	svDemo.fileSize = 0;
+	svDemo.lastTime = -1;
+	svDemo.nextKeyframeTime = 0;
+	svDemo.keyframeMsec = sv_demoKeyframe->integer * 1000;
+	if ( svDemo.keyframeMsec < 1000 ) {
+		svDemo.keyframeMsec = 1000;
+	}
+	svDemo.numKeyframes = 0;
+
+	Com_Memset( mapname, 0, sizeof( mapname ) );
+	Q_strncpyz( mapname, sv_mapname->string, sizeof( mapname ) );
+
+	SV_DemoWrite( "SVDM", 4 );
+	SV_DemoWriteLong( SVDEMO_VERSION );
+	SV_DemoWriteLong( sv_fps->integer );
+	SV_DemoWriteLong( sv_maxclients->integer );
+	SV_DemoWriteLong( svDemo.keyframeMsec );
+	SV_DemoWrite( mapname, sizeof( mapname ) );
+
+	Com_Printf( "Recording server demo to %s\n", svDemo.name );
+}
+
+/*
+==================
+SV_DemoStartDated
+
+Names the demo after the date and the map
+==================
+*/
+static void SV_DemoStartDated( void ) {
+	qtime_t	now;
+
+	Com_RealTime( &now );
+	SV_DemoStart( va( "%04d%02d%02d-%02d%02d%02d-%s", 1900 + now.tm_year, 1 + now.tm_mon,
+		now.tm_mday, now.tm_hour, now.tm_min, now.tm_sec, sv_mapname->string ) );
+}
+
+/*
+==================
+SV_DemoAutoRecord
+
+Called when a map has finished loading
+==================
+*/
+void SV_DemoAutoRecord( void ) {
+	if ( sv_autoRecord->integer ) {
+		SV_DemoStartDated();
+	}
+}
+
+/*
+==================
+SV_DemoConfigstringModified
+==================
+*/
+void SV_DemoConfigstringModified( int index ) {
+	if ( svDemo.file ) {
+		svDemo.configstringModified[index] = 1;
+	}
+}
+
+/*
+==================
+SV_DemoWriteEntities
+
+Same filter as the snapshots, minus the PVS
+==================
+*/
+static void SV_DemoWriteEntities( msg_t *msg, qboolean keyframe ) {
+	static entityState_t	nullstate;
+	sharedEntity_t	*ent;
+	int				e, count;
+	qboolean		valid;
+
+	count = sv.num_entities;
+	if ( count < svDemo.numEntities ) {
+		count = svDemo.numEntities;
+	}
+
+	for ( e = 0 ; e < count ; e++ ) {
+		valid = qfalse;
+		if ( e < sv.num_entities ) {
+			ent = SV_GentityNum( e );
+			valid = ( ent->r.linked && !( ent->r.svFlags & SVF_NOCLIENT ) ) ? qtrue : qfalse;
+		}
+
+		if ( valid ) {
+			if ( keyframe || !svDemo.entityValid[e] ) {
+				MSG_WriteDeltaEntity( msg, &nullstate, &ent->s, qtrue );
+			} else {
+				MSG_WriteDeltaEntity( msg, &svDemo.entities[e], &ent->s, qfalse );
+			}
+			svDemo.entities[e] = ent->s;
+		} else if ( svDemo.entityValid[e] && !keyframe ) {
+			// the entity went away
+			MSG_WriteDeltaEntity( msg, &svDemo.entities[e], NULL, qtrue );
+		}
+		svDemo.entityValid[e] = (byte)valid;
+	}
+	svDemo.numEntities = sv.num_entities;
+
+	MSG_WriteBits( msg, (MAX_GENTITIES-1), GENTITYNUM_BITS );
+}
+
+/*
+==================
+SV_DemoFrame
+
+Records the world as the game left it this frame
+==================
+*/
+void SV_DemoFrame( void ) {
+	msg_t		msg;
+	qboolean	keyframe;
+	int			i;
+	client_t	*cl;
+	playerState_t	*ps;
+
+	if ( !svDemo.file || sv.state != SS_GAME || svs.time == svDemo.lastTime ) {
+		return;
+	}
+	svDemo.lastTime = svs.time;
+
+	keyframe = ( svs.time >= svDemo.nextKeyframeTime ) ? qtrue : qfalse;
+	if ( keyframe ) {
+		svDemo.nextKeyframeTime = svs.time + svDemo.keyframeMsec;
+		if ( svDemo.numKeyframes < MAX_DEMO_KEYFRAMES ) {
+			svDemo.keyframes[svDemo.numKeyframes].serverTime = svs.time;
+			svDemo.keyframes[svDemo.numKeyframes].offset = svDemo.fileSize;
+			svDemo.numKeyframes++;
+		}
+	}
+
+	MSG_Init( &msg, svDemoMsgBuf, sizeof( svDemoMsgBuf ) );
+	MSG_Bitstream( &msg );
+
+	MSG_WriteLong( &msg, svs.time );
+	MSG_WriteByte( &msg, keyframe ? SVDEMO_KEYFRAME : 0 );
+
+	for ( i = 0 ; i < MAX_CONFIGSTRINGS ; i++ ) {
+		if ( keyframe ? sv.configstrings[i][0] != 0 : svDemo.configstringModified[i] ) {
+			MSG_WriteShort( &msg, i );
+			MSG_WriteBigString( &msg, sv.configstrings[i] );
+		}
+	}
+	Com_Memset( svDemo.configstringModified, 0, sizeof( svDemo.configstringModified ) );
+	MSG_WriteShort( &msg, MAX_CONFIGSTRINGS );
+
+	for ( i = 0, cl = svs.clients ; i < sv_maxclients->integer ; i++, cl++ ) {
+		if ( cl->state != CS_ACTIVE ) {
+			svDemo.playerValid[i] = 0;
+			continue;
+		}
+		ps = SV_GameClientNum( i );
+		MSG_WriteByte( &msg, i );
+		MSG_WriteDeltaPlayerstate( &msg, ( keyframe || !svDemo.playerValid[i] ) ? NULL : &svDemo.players[i], ps );
+		svDemo.players[i] = *ps;
+		svDemo.playerValid[i] = 1;
+	}
+	MSG_WriteByte( &msg, MAX_CLIENTS );
+
+	SV_DemoWriteEntities( &msg, keyframe );
+
+	if ( msg.overflowed ) {
+		Com_Printf( "WARNING: server demo frame overflowed\n" );
+		SV_DemoStop();
+		return;
+	}
+
+	SV_DemoWriteLong( msg.cursize );
+	SV_DemoWrite( msg.data, msg.cursize );
+}
+
+/*
+==================
+SV_Record_f
+
+sv_record [name]
+==================
+*/
+void SV_Record_f( void ) {
+	if ( !com_sv_running->integer || sv.state != SS_GAME ) {
+		Com_Printf( "Server is not running.\n" );
+		return;
+	}
+
+	if ( Cmd_Argc() > 2 ) {
+		Com_Printf( "usage: sv_record [name]\n" );
+		return;
+	}
+
+	if ( Cmd_Argc() == 2 ) {
+		SV_DemoStart( Cmd_Argv( 1 ) );
+	} else {
+		SV_DemoStartDated();
+	}
+}
+
+/*
+==================
+SV_StopRecord_f
+==================
+*/
+void SV_StopRecord_f( void ) {
+	if ( !svDemo.file ) {
+		Com_Printf( "Not recording a server demo.\n" );
+		return;
+	}
+	SV_DemoStop();
+}
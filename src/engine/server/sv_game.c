@@ -300,7 +300,7 @@ static int	FloatAsInt( float f ) {
 
 /*
 ====================
-SV_GameSystemCalls
+SV_GameTrap
 
 The module is making a system call
 ====================
@@ -308,7 +308,7 @@ The module is making a system call
 #define	VMA(x) VM_ArgPtr(args[x])
 #define	VMF(x) (*(float*)&args[x])
 
-intptr_t SV_GameSystemCalls( intptr_t *args ) {
+static intptr_t SV_GameTrap( intptr_t *args ) {
 	switch( args[0] ) {
 	case G_PRINT:
 		Com_Printf( "%s", VMA(1) );
@@ -357,6 +357,19 @@ intptr_t SV_GameSystemCalls( intptr_t *args ) {
 	case G_FS_SEEK:
 		return FS_Seek( args[1], args[2], args[3] );
 
+	case G_PROFILE_BEGIN:
+		// the name lives in vm memory, which can move or change
+		if ( com_profiling ) {
+			Prof_Begin( Prof_InternName( (const char*) VMA(1) ) );
+		}
+		return 0;
+	case G_PROFILE_END:
+		PROF_END();
+		return 0;
+	case G_TRACE_AT_TIME:
+		SV_TraceAtTime( (trace_t*)VMA(1), (const vec_t*)VMA(2), (vec_t*)VMA(3), (vec_t*)VMA(4), (const vec_t*)VMA(5), args[6], args[7], /*int capsule*/ qfalse, args[8] );
+		return 0;
+
 	case G_LOCATE_GAME_DATA:
 		SV_LocateGameData( (sharedEntity_t*) VMA(1), args[2], args[3], (playerState_t*) VMA(4), args[5] );
 		return 0;
@@ -861,6 +874,54 @@ intptr_t SV_GameSystemCalls( intptr_t *args ) {
 	return -1;
 }
 
+/*
+====================
+SV_BotlibZoneName
+
+Botlib is profiled at the syscall boundary, a zone for each group of exports
+====================
+*/
+static const char *SV_BotlibZoneName( int trap ) {
+	if ( trap == BOTLIB_START_FRAME ) {
+		return "BotLibStartFrame";
+	}
+	if ( trap >= BOTLIB_AI_LOAD_CHARACTER ) {
+		return "botlib AI";
+	}
+	if ( trap >= BOTLIB_EA_SAY ) {
+		return "botlib EA";
+	}
+	if ( trap >= BOTLIB_AAS_ENABLE_ROUTING_AREA ) {
+		return "botlib AAS";
+	}
+	return "botlib";
+}
+
+/*
+====================
+SV_GameSystemCalls
+
+BotLibStartFrame gets a zone with com_profile 1, the far more frequent
+AAS, EA and AI calls only with com_profile 2
+====================
+*/
+intptr_t SV_GameSystemCalls( intptr_t *args ) {
+	intptr_t	ret;
+
+	if ( !com_profiling || args[0] < BOTLIB_SETUP ) {
+		return SV_GameTrap( args );
+	}
+	if ( args[0] != BOTLIB_START_FRAME && com_profiling < 2 ) {
+		return SV_GameTrap( args );
+	}
+
+	Prof_Begin( SV_BotlibZoneName( (int)args[0] ) );
+	ret = SV_GameTrap( args );
+	Prof_End();
+
+	return ret;
+}
+
 /*
 ===============
 SV_ShutdownGameProgs
@@ -49,6 +49,7 @@ void SV_SetConfigstring (int index, const char *val) {
 	// change the string in sv
 	Z_Free( sv.configstrings[index] );
 	sv.configstrings[index] = CopyString( val );
+	SV_DemoConfigstringModified( index );
 
 	// send it to all the clients if we aren't
 	// spawning a new server
@@ -335,6 +336,60 @@ void SV_TouchCGame(void) {
 	}
 }
 
+/*
+================
+SV_UpdateDownloadServer
+
+Starts or stops the HTTP download server to match sv_httpPort and gives
+it the pk3s that clients may need for this map, with the same rules
+SV_WriteDownloadToClient applies
+================
+*/
+static void SV_UpdateDownloadServer( void ) {
+	static char	names[MAX_HTTP_FILES][MAX_QPATH];
+	const char	*namePtrs[MAX_HTTP_FILES];
+	const char	*osPaths[MAX_HTTP_FILES];
+	char		list[BIG_INFO_STRING];
+	char		*s, *pak;
+	int			numFiles;
+
+	if ( !sv_httpPort->integer ) {
+		Sys_StopDownloadServer();
+		return;
+	}
+	Sys_StartDownloadServer( sv_httpPort->integer );
+	if ( !sv_dlURL->string[0] ) {
+		Com_Printf( "WARNING: sv_dlURL is not set, clients will not be sent to the download server\n" );
+	}
+
+	numFiles = 0;
+	if ( sv_allowDownload->integer ) {
+		Q_strncpyz( list, Cvar_VariableString( "sv_referencedPakNames" ), sizeof( list ) );
+		s = list;
+		while ( *s && numFiles < MAX_HTTP_FILES ) {
+			pak = s;
+			while ( *s && *s != ' ' ) {
+				s++;
+			}
+			if ( *s ) {
+				*s++ = 0;
+			}
+			if ( !*pak || FS_idPak( pak, "baseq3" ) || FS_idPak( pak, "missionpack" ) ) {
+				continue;
+			}
+			osPaths[numFiles] = FS_PakOSPath( pak );
+			if ( !osPaths[numFiles] ) {
+				continue;
+			}
+			Com_sprintf( names[numFiles], sizeof( names[numFiles] ), "%s.pk3", pak );
+			namePtrs[numFiles] = names[numFiles];
+			numFiles++;
+		}
+	}
+
+	Sys_SetDownloadFiles( numFiles, namePtrs, osPaths );
+}
+
 /*
 ================
 SV_SpawnServer
@@ -351,6 +406,9 @@ void SV_SpawnServer( char *server, qboolean killBots ) {
 	char		systemInfo[16384];
 	const char	*p;
 
+	// a server demo covers a single map
+	SV_DemoStop();
+
 	// shut down the existing game if it is running
 	SV_ShutdownGameProgs();
 
@@ -452,6 +510,9 @@ void SV_SpawnServer( char *server, qboolean killBots ) {
 		if (svs.clients[i].state >= CS_CONNECTED) {
 			char	*denied;
 
+			// entity numbers are handed out again on the new map
+			Com_Memset( svs.clients[i].entityDeferrals, 0, sizeof( svs.clients[i].entityDeferrals ) );
+
 			if ( svs.clients[i].netchan.remoteAddress.type == NA_BOT ) {
 				if ( killBots ) {
 					SV_DropClient( &svs.clients[i], "" );
@@ -527,6 +588,8 @@ void SV_SpawnServer( char *server, qboolean killBots ) {
 	p = FS_ReferencedPakNames();
 	Cvar_Set( "sv_referencedPakNames", p );
 
+	SV_UpdateDownloadServer();
+
 	// save systeminfo and serverinfo strings
 	Q_strncpyz( systemInfo, Cvar_InfoString_Big( CVAR_SYSTEMINFO ), sizeof( systemInfo ) );
 	cvar_modifiedFlags &= ~CVAR_SYSTEMINFO;
@@ -543,6 +606,8 @@ void SV_SpawnServer( char *server, qboolean killBots ) {
 	// send a heartbeat now so the master will get up to date info
 	SV_Heartbeat_f();
 
+	SV_DemoAutoRecord();
+
 	Hunk_SetMark();
 
 	Com_Printf ("-----------------------------------\n");
@@ -599,6 +664,8 @@ void SV_Init (void) {
 	Cvar_Get ("nextmap", "", CVAR_TEMP );
 
 	sv_allowDownload = Cvar_Get ("sv_allowDownload", "0", CVAR_SERVERINFO);
+	sv_httpPort = Cvar_Get ("sv_httpPort", "0", CVAR_ARCHIVE );
+	sv_dlURL = Cvar_Get ("sv_dlURL", "", CVAR_SYSTEMINFO | CVAR_ARCHIVE );
 	sv_master[0] = Cvar_Get ("sv_master1", MASTER_SERVER_NAME, 0 );
 	sv_master[1] = Cvar_Get ("sv_master2", "", CVAR_ARCHIVE );
 	sv_master[2] = Cvar_Get ("sv_master3", "", CVAR_ARCHIVE );
@@ -611,6 +678,10 @@ void SV_Init (void) {
 	sv_mapChecksum = Cvar_Get ("sv_mapChecksum", "", CVAR_ROM);
 	sv_lanForceRate = Cvar_Get ("sv_lanForceRate", "1", CVAR_ARCHIVE );
 	sv_strictAuth = Cvar_Get ("sv_strictAuth", "1", CVAR_ARCHIVE );
+	sv_snapshotPriority = Cvar_Get ("sv_snapshotPriority", "1", CVAR_ARCHIVE );
+	sv_antilagMaxMsec = Cvar_Get ("sv_antilagMaxMsec", "500", CVAR_ARCHIVE );
+	sv_autoRecord = Cvar_Get ("sv_autoRecord", "0", CVAR_ARCHIVE );
+	sv_demoKeyframe = Cvar_Get ("sv_demoKeyframe", "10", CVAR_ARCHIVE );
 
 	// initialize bot cvars so they are listed and can be set before loading the botlib
 	SV_BotInitCvars();
@@ -671,6 +742,8 @@ void SV_Shutdown( char *finalmsg ) {
 		SV_FinalMessage( finalmsg );
 	}
 
+	SV_DemoStop();
+	Sys_StopDownloadServer();
 	SV_RemoveOperatorCommands();
 	SV_MasterShutdown();
 	SV_ShutdownGameProgs();
@@ -32,6 +32,8 @@ cvar_t	*sv_zombietime;			// seconds to sink messages after disconnect
 cvar_t	*sv_rconPassword;		// password for remote server commands
 cvar_t	*sv_privatePassword;	// password for the privateClient slots
 cvar_t	*sv_allowDownload;
+cvar_t	*sv_httpPort;			// TCP port of the built in pk3 download server, 0 is off
+cvar_t	*sv_dlURL;				// where clients that can use HTTP get pk3s from
 cvar_t	*sv_maxclients;
 
 cvar_t	*sv_privateClients;		// number of clients reserved for password
@@ -52,6 +54,10 @@ cvar_t	*sv_pure;
 cvar_t	*sv_floodProtect;
 cvar_t	*sv_lanForceRate; // dedicated 1 (LAN) server forces local client rates to 99999 (bug #491)
 cvar_t	*sv_strictAuth;
+cvar_t	*sv_antilagMaxMsec;	// how far back SV_TraceAtTime will rewind the clients
+cvar_t	*sv_snapshotPriority;	// fit snapshots to the client rate by holding back low priority entities
+cvar_t	*sv_autoRecord;		// record a server demo of every map
+cvar_t	*sv_demoKeyframe;	// seconds between server demo keyframes
 
 /*
 =============================================================================
@@ -591,7 +597,9 @@ void SV_PacketEvent( netadr_t from, msg_t *msg ) {
 			// reliable message, but they don't do any other processing
 			if (cl->state != CS_ZOMBIE) {
 				cl->lastPacketTime = svs.time;	// don't timeout
+				PROF_BEGIN( "SV_ExecuteClientMessage" );
 				SV_ExecuteClientMessage( cl, msg );
+				PROF_END();
 			}
 		}
 		return;
@@ -807,6 +815,8 @@ void SV_Frame( int msec ) {
 		return;
 	}
 
+	PROF_BEGIN( "SV_Frame" );
+
 	// update infostrings if anything has been changed
 	if ( cvar_modifiedFlags & CVAR_SERVERINFO ) {
 		SV_SetConfigstring( CS_SERVERINFO, Cvar_InfoString( CVAR_SERVERINFO ) );
@@ -835,8 +845,14 @@ void SV_Frame( int msec ) {
 
 		// let everything in the world think and move
 		VM_Call( gvm, GAME_RUN_FRAME, svs.time );
+
+		// remember where the players ended up, for lag compensated traces
+		SV_RecordPositionHistory();
 	}
 
+	// record the world as this frame left it
+	SV_DemoFrame();
+
 	if ( com_speeds->integer ) {
 		time_game = Sys_Milliseconds () - startTime;
 	}
@@ -849,6 +865,8 @@ void SV_Frame( int msec ) {
 
 	// send a heartbeat to the master if needed
 	SV_MasterHeartbeat();
+
+	PROF_END();
 }
 
 //============================================================================
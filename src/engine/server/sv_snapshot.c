@@ -114,6 +114,269 @@ static void SV_EmitPacketEntities( clientSnapshot_t *from, clientSnapshot_t *to,
 
 
 
+/*
+=============================================================================
+
+Entity prioritization
+
+When the changed entities of a snapshot will not fit in what the client
+rate allows for one snapshot, the most important updates go out and the
+rest are held back. A held back entity that the client already has is
+stored in the frame with the state the client already knows, so the delta
+writes nothing for it and the next snapshot deltas from what the client
+really has. A held back new entity is left out of the frame, so it will
+be sent from the baseline later. The entity order on the wire is still
+ascending, so clients see nothing unusual.
+
+=============================================================================
+*/
+
+#define	HEADER_RATE_BYTES		48		// include our header, IP header, and some overhead
+#define	MAX_ENTITY_DEFERRALS	8		// after this many snapshots an update must go out
+
+typedef struct {
+	int			index;				// in the new frame
+	int			oldIndex;			// in the delta frame, -1 if new
+	int			bits;				// cost of the delta
+	qboolean	mandatory;			// events, or waited too long already
+	float		priority;
+	qboolean	deferred;
+} packedEntity_t;
+
+static packedEntity_t	packedEntities[MAX_GENTITIES];
+static packedEntity_t	*packedOrder[MAX_GENTITIES];
+static byte				packScratch[MAX_MSGLEN];
+
+/*
+====================
+SV_ClientRate
+
+Bytes per second, capped by sv_maxRate
+====================
+*/
+static int SV_ClientRate( client_t *client ) {
+	int		rate;
+
+	rate = client->rate;
+	if ( sv_maxRate->integer ) {
+		if ( sv_maxRate->integer < 1000 ) {
+			Cvar_Set( "sv_MaxRate", "1000" );
+		}
+		if ( sv_maxRate->integer < rate ) {
+			rate = sv_maxRate->integer;
+		}
+	}
+	return rate;
+}
+
+/*
+====================
+SV_EntityPriority
+
+Close, fast, in view players and missiles first, and anything that has
+waited for a while climbs up
+====================
+*/
+static float SV_EntityPriority( client_t *client, clientSnapshot_t *frame, entityState_t *ent, const vec3_t forward ) {
+	vec3_t	delta;
+	float	dist;
+	float	priority;
+
+	VectorSubtract( ent->pos.trBase, frame->ps.origin, delta );
+	dist = VectorLength( delta );
+
+	priority = 1000.0f / ( dist + 100.0f );
+	priority += VectorLength( ent->pos.trDelta ) * 0.005f;
+	priority += client->entityDeferrals[ent->number] * 2.0f;
+	if ( ent->eType == ET_PLAYER || ent->eType == ET_MISSILE ) {
+		priority += 4.0f;
+	}
+	if ( DotProduct( delta, forward ) > 0 ) {
+		priority *= 1.5f;
+	}
+
+	return priority;
+}
+
+/*
+====================
+SV_SortPackedEntities
+====================
+*/
+static int QDECL SV_SortPackedEntities( const void *a, const void *b ) {
+	const packedEntity_t	*pa = *(const packedEntity_t **)a;
+	const packedEntity_t	*pb = *(const packedEntity_t **)b;
+
+	if ( pa->mandatory != pb->mandatory ) {
+		return pa->mandatory ? -1 : 1;
+	}
+	if ( pa->priority > pb->priority ) {
+		return -1;
+	}
+	if ( pa->priority < pb->priority ) {
+		return 1;
+	}
+	return pa->index - pb->index;
+}
+
+/*
+====================
+SV_PrioritizePacketEntities
+
+Trims the changes in frame "to" down to the rate budget of one snapshot,
+msg holds everything written ahead of the entities
+====================
+*/
+static void SV_PrioritizePacketEntities( client_t *client, clientSnapshot_t *from, clientSnapshot_t *to, msg_t *msg ) {
+	entityState_t	*oldent, *newent;
+	packedEntity_t	*p;
+	msg_t			scratch;
+	vec3_t			forward;
+	int				oldindex, newindex;
+	int				oldnum, newnum;
+	int				numPacked, numDeferred;
+	int				budget, fixed, total;
+	int				firstAbsent;
+	int				i, j;
+
+	// what one snapshot may cost at this rate, in bits
+	budget = ( SV_ClientRate( client ) * client->snapshotMsec / 1000 - HEADER_RATE_BYTES - msg->cursize ) * 8;
+
+	MSG_Init( &scratch, packScratch, sizeof( packScratch ) );
+
+	// measure every change the way SV_EmitPacketEntities will write it,
+	// removals and the terminator always go out
+	numPacked = 0;
+	fixed = GENTITYNUM_BITS;
+	total = 0;
+	firstAbsent = 0;
+	oldindex = 0;
+	newindex = 0;
+	while ( newindex < to->num_entities || oldindex < from->num_entities ) {
+		newent = NULL;
+		oldent = NULL;
+		newnum = oldnum = 9999;
+		if ( newindex < to->num_entities ) {
+			newent = &svs.snapshotEntities[(to->first_entity+newindex) % svs.numSnapshotEntities];
+			newnum = newent->number;
+		}
+		if ( oldindex < from->num_entities ) {
+			oldent = &svs.snapshotEntities[(from->first_entity+oldindex) % svs.numSnapshotEntities];
+			oldnum = oldent->number;
+		}
+
+		scratch.cursize = 0;
+		scratch.bit = 0;
+		if ( newnum > oldnum ) {
+			MSG_WriteDeltaEntity( &scratch, oldent, NULL, qtrue );
+			fixed += scratch.bit;
+			oldindex++;
+			continue;
+		}
+
+		// an entity that dropped out of the frame starts over when
+		// its number is used again
+		if ( newnum > firstAbsent ) {
+			Com_Memset( client->entityDeferrals + firstAbsent, 0, newnum - firstAbsent );
+		}
+		firstAbsent = newnum + 1;
+
+		if ( newnum == oldnum ) {
+			MSG_WriteDeltaEntity( &scratch, oldent, newent, qfalse );
+		} else {
+			MSG_WriteDeltaEntity( &scratch, &sv.svEntities[newnum].baseline, newent, qtrue );
+		}
+
+		if ( scratch.bit ) {
+			p = &packedEntities[numPacked];
+			p->index = newindex;
+			p->oldIndex = ( newnum == oldnum ) ? oldindex : -1;
+			p->bits = scratch.bit;
+			p->mandatory = ( newent->eType >= ET_EVENTS || client->entityDeferrals[newnum] >= MAX_ENTITY_DEFERRALS
+				|| ( p->oldIndex >= 0 && newent->event != oldent->event ) ) ? qtrue : qfalse;
+			p->priority = 0;
+			p->deferred = qfalse;
+			packedOrder[numPacked++] = p;
+			total += scratch.bit;
+		}
+
+		if ( newnum == oldnum ) {
+			oldindex++;
+		}
+		newindex++;
+	}
+	if ( firstAbsent < MAX_GENTITIES ) {
+		Com_Memset( client->entityDeferrals + firstAbsent, 0, MAX_GENTITIES - firstAbsent );
+	}
+
+	if ( fixed + total <= budget ) {
+		for ( i = 0 ; i < numPacked ; i++ ) {
+			newent = &svs.snapshotEntities[(to->first_entity+packedEntities[i].index) % svs.numSnapshotEntities];
+			client->entityDeferrals[newent->number] = 0;
+		}
+		return;
+	}
+
+	// fill the budget in priority order
+	AngleVectors( to->ps.viewangles, forward, NULL, NULL );
+	for ( i = 0 ; i < numPacked ; i++ ) {
+		p = &packedEntities[i];
+		if ( !p->mandatory ) {
+			newent = &svs.snapshotEntities[(to->first_entity+p->index) % svs.numSnapshotEntities];
+			p->priority = SV_EntityPriority( client, to, newent, forward );
+		}
+	}
+	qsort( packedOrder, numPacked, sizeof( packedOrder[0] ), SV_SortPackedEntities );
+
+	total = fixed;
+	for ( i = 0 ; i < numPacked ; i++ ) {
+		p = packedOrder[i];
+		if ( !p->mandatory && total + p->bits > budget ) {
+			p->deferred = qtrue;
+			continue;
+		}
+		total += p->bits;
+	}
+
+	// hold back what didn't make it
+	numDeferred = 0;
+	for ( i = 0 ; i < numPacked ; i++ ) {
+		p = &packedEntities[i];
+		newent = &svs.snapshotEntities[(to->first_entity+p->index) % svs.numSnapshotEntities];
+		if ( !p->deferred ) {
+			client->entityDeferrals[newent->number] = 0;
+			continue;
+		}
+
+		client->entityDeferrals[newent->number]++;
+		if ( p->oldIndex >= 0 ) {
+			// keep what the client already has
+			*newent = svs.snapshotEntities[(from->first_entity+p->oldIndex) % svs.numSnapshotEntities];
+		} else {
+			// dropped from the frame below
+			newent->number = MAX_GENTITIES;
+			numDeferred++;
+		}
+	}
+
+	if ( !numDeferred ) {
+		return;
+	}
+
+	// close the gaps left by new entities that were held back
+	for ( i = 0, j = 0 ; i < to->num_entities ; i++ ) {
+		newent = &svs.snapshotEntities[(to->first_entity+i) % svs.numSnapshotEntities];
+		if ( newent->number == MAX_GENTITIES ) {
+			continue;
+		}
+		if ( i != j ) {
+			svs.snapshotEntities[(to->first_entity+j) % svs.numSnapshotEntities] = *newent;
+		}
+		j++;
+	}
+	to->num_entities = j;
+}
+
 /*
 ==================
 SV_WriteSnapshotToClient
@@ -186,6 +449,14 @@ static void SV_WriteSnapshotToClient( client_t *client, msg_t *msg ) {
 		MSG_WriteDeltaPlayerstate( msg, NULL, &frame->ps );
 	}
 
+	// fit the entities to the client rate
+	if ( oldframe && sv_snapshotPriority->integer ) {
+		SV_PrioritizePacketEntities( client, oldframe, frame, msg );
+	} else {
+		// everything goes out, nothing has waited
+		Com_Memset( client->entityDeferrals, 0, sizeof( client->entityDeferrals ) );
+	}
+
 	// delta encode the entities
 	SV_EmitPacketEntities (oldframe, frame, msg);
 
@@ -523,25 +794,14 @@ Return the number of msec a given size message is supposed
 to take to clear, based on the current rate
 ====================
 */
-#define	HEADER_RATE_BYTES	48		// include our header, IP header, and some overhead
 static int SV_RateMsec( client_t *client, int messageSize ) {
-	int		rate;
 	int		rateMsec;
 
 	// individual messages will never be larger than fragment size
 	if ( messageSize > 1500 ) {
 		messageSize = 1500;
 	}
-	rate = client->rate;
-	if ( sv_maxRate->integer ) {
-		if ( sv_maxRate->integer < 1000 ) {
-			Cvar_Set( "sv_MaxRate", "1000" );
-		}
-		if ( sv_maxRate->integer < rate ) {
-			rate = sv_maxRate->integer;
-		}
-	}
-	rateMsec = ( messageSize + HEADER_RATE_BYTES ) * 1000 / rate;
+	rateMsec = ( messageSize + HEADER_RATE_BYTES ) * 1000 / SV_ClientRate( client );
 
 	return rateMsec;
 }
@@ -656,6 +916,8 @@ void SV_SendClientMessages( void ) {
 	int			i;
 	client_t	*c;
 
+	PROF_BEGIN( "SV_SendClientMessages" );
+
 	// send a message to each connected client
 	for (i=0, c = svs.clients ; i < sv_maxclients->integer ; i++, c++) {
 		if (!c->state) {
@@ -678,5 +940,7 @@ void SV_SendClientMessages( void ) {
 		// generate and send a new message
 		SV_SendClientSnapshot( c );
 	}
+
+	PROF_END();
 }
 
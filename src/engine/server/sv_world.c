@@ -147,6 +147,7 @@ SV_ClearWorld
 void SV_ClearWorld( void ) {
 	clipHandle_t	h;
 	vec3_t			mins, maxs;
+	int				i;
 
 	Com_Memset( sv_worldSectors, 0, sizeof(sv_worldSectors) );
 	sv_numworldSectors = 0;
@@ -155,6 +156,13 @@ void SV_ClearWorld( void ) {
 	h = CM_InlineModel( 0 );
 	CM_ModelBounds( h, mins, maxs );
 	SV_CreateworldSector( 0, mins, maxs );
+
+	// positions from the last map mean nothing on this one
+	if ( svs.clients ) {
+		for ( i = 0 ; i < sv_maxclients->integer ; i++ ) {
+			svs.clients[i].numPositions = 0;
+		}
+	}
 }
 
 
@@ -456,6 +464,8 @@ typedef struct {
 	int			passEntityNum;
 	int			contentmask;
 	int			capsule;
+	qboolean	rewind;			// clip against the clients' positionHistory
+	int			rewindTime;
 } moveclip_t;
 
 
@@ -533,6 +543,11 @@ void SV_ClipMoveToEntities( moveclip_t *clip ) {
 		}
 		touch = SV_GentityNum( touchlist[i] );
 
+		// rewound clients are clipped against separately
+		if ( clip->rewind && touchlist[i] < sv_maxclients->integer ) {
+			continue;
+		}
+
 		// see if we should ignore this entity
 		if ( clip->passEntityNum != ENTITYNUM_NONE ) {
 			if ( touchlist[i] == clip->passEntityNum ) {
@@ -594,15 +609,178 @@ void SV_ClipMoveToEntities( moveclip_t *clip ) {
 }
 
 
+/*
+===============================================================================
+
+LAG COMPENSATION
+
+After every game frame the position of each client's entity goes into a
+ring in its client_t. SV_TraceAtTime clips against those instead of the
+linked entities, so a hitscan shot can be tested against where the targets
+were on the shooter's screen. Nothing is relinked: the rewound boxes are
+checked against the bounds of the move and only the few that overlap get
+an exact clip, so a rewound trace costs about the same as a normal one.
+
+===============================================================================
+*/
+
+/*
+====================
+SV_RecordPositionHistory
+====================
+*/
+void SV_RecordPositionHistory( void ) {
+	int					i;
+	client_t			*cl;
+	sharedEntity_t		*ent;
+	clientPosition_t	*pos;
+
+	for ( i = 0, cl = svs.clients ; i < sv_maxclients->integer ; i++, cl++ ) {
+		pos = &cl->positionHistory[cl->numPositions & ( MAX_POSITION_HISTORY - 1 )];
+		cl->numPositions++;
+
+		pos->time = svs.time;
+		if ( cl->state != CS_ACTIVE ) {
+			pos->contents = 0;
+			pos->teleportBit = 0;
+			continue;
+		}
+
+		ent = SV_GentityNum( i );
+		VectorCopy( ent->r.currentOrigin, pos->origin );
+		VectorCopy( ent->r.mins, pos->mins );
+		VectorCopy( ent->r.maxs, pos->maxs );
+		pos->contents = ent->r.linked ? ent->r.contents : 0;
+		pos->teleportBit = ent->s.eFlags & EF_TELEPORT_BIT;
+		pos->capsule = ( ent->r.svFlags & SVF_CAPSULE ) ? qtrue : qfalse;
+	}
+}
+
+/*
+====================
+SV_ClientPositionAtTime
+
+Interpolates between the frames around time, but never across a
+teleport or respawn. Returns qfalse if the client couldn't be hit then.
+====================
+*/
+static qboolean SV_ClientPositionAtTime( const client_t *cl, int time, clientPosition_t *out ) {
+	const clientPosition_t	*newer, *older;
+	int						i, count;
+	float					frac;
+
+	count = cl->numPositions;
+	if ( count > MAX_POSITION_HISTORY ) {
+		count = MAX_POSITION_HISTORY;
+	}
+	if ( !count ) {
+		return qfalse;
+	}
+
+	newer = &cl->positionHistory[( cl->numPositions - 1 ) & ( MAX_POSITION_HISTORY - 1 )];
+	older = newer;
+	for ( i = 1 ; i < count && newer->time > time ; i++ ) {
+		older = &cl->positionHistory[( cl->numPositions - 1 - i ) & ( MAX_POSITION_HISTORY - 1 )];
+		if ( older->time <= time ) {
+			break;
+		}
+		newer = older;
+	}
+
+	if ( older == newer ) {
+		// at or past either end of the history
+		*out = *newer;
+	} else if ( older->teleportBit != newer->teleportBit || !older->contents || !newer->contents ) {
+		*out = ( time - older->time < newer->time - time ) ? *older : *newer;
+	} else {
+		frac = (float)( time - older->time ) / ( newer->time - older->time );
+		*out = *newer;
+		for ( i = 0 ; i < 3 ; i++ ) {
+			out->origin[i] = older->origin[i] + frac * ( newer->origin[i] - older->origin[i] );
+		}
+	}
+
+	return out->contents ? qtrue : qfalse;
+}
+
+/*
+====================
+SV_ClipMoveToRewoundClients
+====================
+*/
+static void SV_ClipMoveToRewoundClients( moveclip_t *clip ) {
+	int					i, j;
+	client_t			*cl;
+	clientPosition_t	pos;
+	clipHandle_t		clipHandle;
+	trace_t				trace;
+
+	for ( i = 0, cl = svs.clients ; i < sv_maxclients->integer ; i++, cl++ ) {
+		if ( clip->trace.allsolid ) {
+			return;
+		}
+		if ( cl->state != CS_ACTIVE || i == clip->passEntityNum ) {
+			continue;
+		}
+		// nobody can be hit who isn't in the world now, this also lets
+		// the railgun unlink what it has gone through
+		if ( !SV_GentityNum( i )->r.linked ) {
+			continue;
+		}
+		if ( !SV_ClientPositionAtTime( cl, clip->rewindTime, &pos ) ) {
+			continue;
+		}
+		if ( !( clip->contentmask & pos.contents ) ) {
+			continue;
+		}
+
+		// most clients are nowhere near the move
+		for ( j = 0 ; j < 3 ; j++ ) {
+			if ( pos.origin[j] + pos.mins[j] > clip->boxmaxs[j]
+				|| pos.origin[j] + pos.maxs[j] < clip->boxmins[j] ) {
+				break;
+			}
+		}
+		if ( j < 3 ) {
+			continue;
+		}
+
+		clipHandle = CM_TempBoxModel( pos.mins, pos.maxs, pos.capsule );
+		CM_TransformedBoxTrace ( &trace, (float *)clip->start, (float *)clip->end,
+			(float *)clip->mins, (float *)clip->maxs, clipHandle, clip->contentmask,
+			pos.origin, vec3_origin, clip->capsule );
+
+		if ( trace.allsolid ) {
+			clip->trace.allsolid = qtrue;
+			trace.entityNum = i;
+		} else if ( trace.startsolid ) {
+			clip->trace.startsolid = qtrue;
+			trace.entityNum = i;
+		}
+
+		if ( trace.fraction < clip->trace.fraction ) {
+			qboolean	oldStart;
+
+			// make sure we keep a startsolid from a previous trace
+			oldStart = clip->trace.startsolid;
+
+			trace.entityNum = i;
+			clip->trace = trace;
+			if ( oldStart ) {
+				clip->trace.startsolid = qtrue;
+			}
+		}
+	}
+}
+
 /*
 ==================
-SV_Trace
+SV_ClipMove
 
-Moves the given mins/maxs volume through the world from start to end.
-passEntityNum and entities owned by passEntityNum are explicitly not checked.
+SV_Trace and SV_TraceAtTime
 ==================
 */
-void SV_Trace( trace_t *results, const vec3_t start, vec3_t mins, vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, int capsule ) {
+static void SV_ClipMove( trace_t *results, const vec3_t start, vec3_t mins, vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, int capsule, qboolean rewind, int rewindTime ) {
 	moveclip_t	clip;
 	int			i;
 
@@ -631,6 +809,8 @@ void SV_Trace( trace_t *results, const vec3_t start, vec3_t mins, vec3_t maxs, c
 	clip.maxs = maxs;
 	clip.passEntityNum = passEntityNum;
 	clip.capsule = capsule;
+	clip.rewind = rewind;
+	clip.rewindTime = rewindTime;
 
 	// create the bounding box of the entire move
 	// we can limit it to the part of the move not
@@ -648,10 +828,44 @@ void SV_Trace( trace_t *results, const vec3_t start, vec3_t mins, vec3_t maxs, c
 
 	// clip to other solid entities
 	SV_ClipMoveToEntities ( &clip );
+	if ( clip.rewind ) {
+		SV_ClipMoveToRewoundClients( &clip );
+	}
 
 	*results = clip.trace;
 }
 
+/*
+==================
+SV_Trace
+
+Moves the given mins/maxs volume through the world from start to end.
+passEntityNum and entities owned by passEntityNum are explicitly not checked.
+==================
+*/
+void SV_Trace( trace_t *results, const vec3_t start, vec3_t mins, vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, int capsule ) {
+	SV_ClipMove( results, start, mins, maxs, end, passEntityNum, contentmask, capsule, qfalse, 0 );
+}
+
+/*
+==================
+SV_TraceAtTime
+
+The same, with the clients where they were at time
+==================
+*/
+void SV_TraceAtTime( trace_t *results, const vec3_t start, vec3_t mins, vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, int capsule, int time ) {
+	if ( sv_antilagMaxMsec->integer <= 0 || time >= svs.time ) {
+		SV_ClipMove( results, start, mins, maxs, end, passEntityNum, contentmask, capsule, qfalse, 0 );
+		return;
+	}
+
+	if ( time < svs.time - sv_antilagMaxMsec->integer ) {
+		time = svs.time - sv_antilagMaxMsec->integer;
+	}
+	SV_ClipMove( results, start, mins, maxs, end, passEntityNum, contentmask, capsule, qtrue, time );
+}
+
 
 
 /*
@@ -66,6 +66,8 @@ int numbots;
 float floattime;
 //time to do a regular update
 float regularupdate_time;
+//entities the botlib has been told are gone, so they aren't sent again every frame
+qboolean botlib_entitycleared[MAX_GENTITIES];
 //
 int bot_interbreed;
 int bot_interbreedmatchcount;
@@ -1315,6 +1317,9 @@ int BotAILoadMap( int restart ) {
 		trap_BotLibLoadMap( mapname.string );
 	}
 
+	//don't trust the botlib to have the same idea of which entities are gone
+	memset(botlib_entitycleared, 0, sizeof(botlib_entitycleared));
+
 	for (i = 0; i < MAX_CLIENTS; i++) {
 		if (botstates[i] && botstates[i]->inuse) {
 			BotResetState( botstates[i] );
@@ -1418,26 +1423,18 @@ int BotAIStartFrame(int time) {
 		//update entities in the botlib
 		for (i = 0; i < MAX_GENTITIES; i++) {
 			ent = &g_entities[i];
-			if (!ent->inuse) {
-				trap_BotLibUpdateEntity(i, NULL);
-				continue;
-			}
-			if (!ent->r.linked) {
-				trap_BotLibUpdateEntity(i, NULL);
-				continue;
-			}
-			if (ent->r.svFlags & SVF_NOCLIENT) {
-				trap_BotLibUpdateEntity(i, NULL);
-				continue;
-			}
-			// do not update missiles
-			if (ent->s.eType == ET_MISSILE && ent->s.weapon != WP_GRAPPLING_HOOK) {
-				trap_BotLibUpdateEntity(i, NULL);
-				continue;
-			}
-			// do not update event only entities
-			if (ent->s.eType > ET_EVENTS) {
-				trap_BotLibUpdateEntity(i, NULL);
+			if (!ent->inuse
+				|| !ent->r.linked
+				|| (ent->r.svFlags & SVF_NOCLIENT)
+				// do not update missiles
+				|| (ent->s.eType == ET_MISSILE && ent->s.weapon != WP_GRAPPLING_HOOK)
+				// do not update event only entities
+				|| ent->s.eType > ET_EVENTS) {
+				// most slots stay empty, only tell the botlib once
+				if (!botlib_entitycleared[i]) {
+					trap_BotLibUpdateEntity(i, NULL);
+					botlib_entitycleared[i] = qtrue;
+				}
 				continue;
 			}
 			//
@@ -1468,6 +1465,7 @@ int BotAIStartFrame(int time) {
 			state.weapon = ent->s.weapon;
 			//
 			trap_BotLibUpdateEntity(i, &state);
+			botlib_entitycleared[i] = qfalse;
 		}
 
 		BotAIRegularUpdate();
@@ -62,6 +62,19 @@ typedef enum {
 
 #define SP_PODIUM_MODEL		"models/mapobjects/podium/podium4.md3"
 
+// the non-client entities in use are kept in a list for each of the ways
+// G_RunFrame runs them, so a frame only visits live entities
+typedef enum {
+	ENTLIST_NONE,		// free, or a client
+	ENTLIST_MOVER,
+	ENTLIST_ITEM,		// items and other physics objects
+	ENTLIST_MISSILE,
+	ENTLIST_THINK,		// everything else
+	ENTLIST_TEMP,		// event entities, freed once the event is over
+
+	NUM_ENTLISTS
+} entityList_t;
+
 //============================================================================
 
 typedef struct gentity_s gentity_t;
@@ -170,6 +183,10 @@ struct gentity_s {
 	float		random;
 
 	gitem_t		*item;			// for bonus items
+
+	entityList_t	activeList;		// which of level.activeEntities it is in
+	gentity_t	*activePrev, *activeNext;
+	gentity_t	*freeNext;			// in level.freeEntities, oldest first
 };
 
 
@@ -327,6 +344,9 @@ typedef struct {
 	int			gentitySize;
 	int			num_entities;		// current number, <= MAX_GENTITIES
 
+	gentity_t	*activeEntities[NUM_ENTLISTS];
+	gentity_t	*freeEntities, *freeEntitiesTail;	// slots in the order they were freed
+
 	int			warmupTime;			// restart match at this time
 
 	fileHandle_t	logFile;
@@ -457,6 +477,8 @@ void	G_UseTargets (gentity_t *ent, gentity_t *activator);
 void	G_SetMovedir ( vec3_t angles, vec3_t movedir);
 
 void	G_InitGentity( gentity_t *e );
+void	G_SetEntityList( gentity_t *e, entityList_t list );
+void	G_UpdateEntityList( gentity_t *e );
 gentity_t	*G_Spawn (void);
 gentity_t *G_TempEntity( vec3_t origin, int event );
 void	G_Sound( gentity_t *ent, int channel, int soundIndex );
@@ -732,6 +754,7 @@ extern	vmCvar_t	g_enableDust;
 extern	vmCvar_t	g_enableBreath;
 extern	vmCvar_t	g_singlePlayer;
 extern	vmCvar_t	g_proxMineTimeout;
+extern	vmCvar_t	g_antilag;
 
 void	trap_Printf( const char *fmt );
 void	trap_Error( const char *fmt );
@@ -937,3 +960,8 @@ int		trap_GeneticParentsAndChildSelection(int numranks, float *ranks, int *paren
 
 void	trap_SnapVector( float *v );
 
+void	trap_ProfileBegin( const char *name );
+void	trap_ProfileEnd( void );
+
+void	trap_TraceAtTime( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, int time );
+
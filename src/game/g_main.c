@@ -77,10 +77,12 @@ vmCvar_t	g_teamForceBalance;
 vmCvar_t	g_banIPs;
 vmCvar_t	g_filterBan;
 vmCvar_t	g_smoothClients;
+vmCvar_t	g_antilag;
 vmCvar_t	pmove_fixed;
 vmCvar_t	pmove_msec;
 vmCvar_t	g_rankings;
 vmCvar_t	g_listEntity;
+vmCvar_t	g_profile;
 
 // bk001129 - made static to avoid aliasing
 static cvarTable_t		gameCvarTable[] = {
@@ -145,8 +147,10 @@ static cvarTable_t		gameCvarTable[] = {
 
 	{ &g_allowVote, "g_allowVote", "1", CVAR_ARCHIVE, 0, qfalse },
 	{ &g_listEntity, "g_listEntity", "0", 0, 0, qfalse },
+	{ &g_profile, "com_profile", "0", 0, 0, qfalse },
 
 	{ &g_smoothClients, "g_smoothClients", "1", 0, 0, qfalse},
+	{ &g_antilag, "g_antilag", "0", CVAR_SERVERINFO | CVAR_ARCHIVE, 0, qtrue },
 	{ &pmove_fixed, "pmove_fixed", "0", CVAR_SYSTEMINFO, 0, qfalse},
 	{ &pmove_msec, "pmove_msec", "8", CVAR_SYSTEMINFO, 0, qfalse},
 
@@ -1628,6 +1632,65 @@ void G_RunThink (gentity_t *ent) {
 	ent->think (ent);
 }
 
+/*
+================
+G_RunEntity
+================
+*/
+static void G_RunEntity( gentity_t *ent ) {
+	// clear events that are too old
+	if ( level.time - ent->eventTime > EVENT_VALID_MSEC ) {
+		if ( ent->s.event ) {
+			ent->s.event = 0;	// &= EV_EVENT_BITS;
+			if ( ent->client ) {
+				ent->client->ps.externalEvent = 0;
+				// predicted events should never be set to zero
+				//ent->client->ps.events[0] = 0;
+				//ent->client->ps.events[1] = 0;
+			}
+		}
+		if ( ent->freeAfterEvent ) {
+			// tempEntities or dropped items completely go away after their event
+			G_FreeEntity( ent );
+			return;
+		} else if ( ent->unlinkAfterEvent ) {
+			// items that will respawn will hide themselves after their pickup event
+			ent->unlinkAfterEvent = qfalse;
+			trap_UnlinkEntity( ent );
+		}
+	}
+
+	// temporary entities don't think
+	if ( ent->freeAfterEvent ) {
+		return;
+	}
+
+	if ( !ent->r.linked && ent->neverFree ) {
+		return;
+	}
+
+	// a profile zone for each entity, named after its class
+	if ( g_profile.integer ) {
+		trap_ProfileBegin( ent->classname ? ent->classname : "noclass" );
+	}
+
+	if ( ent->s.eType == ET_MISSILE ) {
+		G_RunMissile( ent );
+	} else if ( ent->s.eType == ET_ITEM || ent->physicsObject ) {
+		G_RunItem( ent );
+	} else if ( ent->s.eType == ET_MOVER ) {
+		G_RunMover( ent );
+	} else if ( ent->s.number < MAX_CLIENTS ) {
+		G_RunClient( ent );
+	} else {
+		G_RunThink( ent );
+	}
+
+	if ( g_profile.integer ) {
+		trap_ProfileEnd();
+	}
+}
+
 /*
 ================
 G_RunFrame
@@ -1636,10 +1699,10 @@ Advances the non-player objects in the world
 ================
 */
 void G_RunFrame( int levelTime ) {
-	int			i;
+	static gentity_t	*runList[MAX_GENTITIES];
+	int			i, list, numRun;
 	gentity_t	*ent;
 	int			msec;
-int start, end;
 
 	// if we are waiting for the level to restart, do nothing
 	if ( level.restarted ) {
@@ -1655,71 +1718,42 @@ int start, end;
 	G_UpdateCvars();
 
 	//
-	// go through all allocated objects
+	// go through all allocated objects, the clients first
 	//
-	start = trap_Milliseconds();
 	ent = &g_entities[0];
-	for (i=0 ; i<level.num_entities ; i++, ent++) {
-		if ( !ent->inuse ) {
-			continue;
-		}
-
-		// clear events that are too old
-		if ( level.time - ent->eventTime > EVENT_VALID_MSEC ) {
-			if ( ent->s.event ) {
-				ent->s.event = 0;	// &= EV_EVENT_BITS;
-				if ( ent->client ) {
-					ent->client->ps.externalEvent = 0;
-					// predicted events should never be set to zero
-					//ent->client->ps.events[0] = 0;
-					//ent->client->ps.events[1] = 0;
-				}
-			}
-			if ( ent->freeAfterEvent ) {
-				// tempEntities or dropped items completely go away after their event
-				G_FreeEntity( ent );
-				continue;
-			} else if ( ent->unlinkAfterEvent ) {
-				// items that will respawn will hide themselves after their pickup event
-				ent->unlinkAfterEvent = qfalse;
-				trap_UnlinkEntity( ent );
-			}
-		}
-
-		// temporary entities don't think
-		if ( ent->freeAfterEvent ) {
-			continue;
-		}
-
-		if ( !ent->r.linked && ent->neverFree ) {
-			continue;
+	for (i=0 ; i<level.maxclients ; i++, ent++) {
+		if ( ent->inuse ) {
+			G_RunEntity( ent );
 		}
+	}
 
-		if ( ent->s.eType == ET_MISSILE ) {
-			G_RunMissile( ent );
-			continue;
+	// then the rest a list at a time. The lists are copied first, running
+	// an entity can spawn or free others, anything spawned now waits for
+	// the next frame
+	numRun = 0;
+	for ( list = ENTLIST_NONE + 1 ; list < NUM_ENTLISTS ; list++ ) {
+		for ( ent = level.activeEntities[list] ; ent ; ent = ent->activeNext ) {
+			runList[numRun++] = ent;
 		}
+	}
 
-		if ( ent->s.eType == ET_ITEM || ent->physicsObject ) {
-			G_RunItem( ent );
-			continue;
+	for ( i = 0 ; i < numRun ; i++ ) {
+		ent = runList[i];
+		if ( !ent->inuse ) {
+			continue;		// freed by something that ran before it
 		}
 
-		if ( ent->s.eType == ET_MOVER ) {
-			G_RunMover( ent );
-			continue;
-		}
+		G_RunEntity( ent );
 
-		if ( i < MAX_CLIENTS ) {
-			G_RunClient( ent );
-			continue;
+		if ( ent->inuse ) {
+			G_UpdateEntityList( ent );
 		}
+	}
 
-		G_RunThink( ent );
+	if ( g_profile.integer ) {
+		trap_ProfileBegin( "ClientEndFrame" );
 	}
-end = trap_Milliseconds();
 
-start = trap_Milliseconds();
 	// perform final fixups on the players
 	ent = &g_entities[0];
 	for (i=0 ; i < level.maxclients ; i++, ent++ ) {
@@ -1727,7 +1761,10 @@ start = trap_Milliseconds();
 			ClientEndFrame( ent );
 		}
 	}
-end = trap_Milliseconds();
+
+	if ( g_profile.integer ) {
+		trap_ProfileEnd();
+	}
 
 	// see if it is time to do a tournement restart
 	CheckTournament();
@@ -229,6 +229,16 @@ typedef enum {
 	// 1.32
 	G_FS_SEEK,
 
+	G_PROFILE_BEGIN,	// ( const char *name );
+	// opens a profile zone, only call it when com_profile is set
+
+	G_PROFILE_END,		// ( void );
+	// closes the zone opened by the last G_PROFILE_BEGIN
+
+	G_TRACE_AT_TIME,	// ( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, int time );
+	// like G_TRACE, but the clients are where they were at the given server
+	// time, for lag compensated hitscan weapons
+
 	BOTLIB_SETUP = 200,				// ( void );
 	BOTLIB_SHUTDOWN,				// ( void );
 	BOTLIB_LIBVAR_SET,
@@ -228,6 +228,18 @@ void trap_SnapVector( float *v ) {
 	return;
 }
 
+void trap_ProfileBegin( const char *name ) {
+	syscall( G_PROFILE_BEGIN, name );
+}
+
+void trap_ProfileEnd( void ) {
+	syscall( G_PROFILE_END );
+}
+
+void trap_TraceAtTime( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, int time ) {
+	syscall( G_TRACE_AT_TIME, results, start, mins, maxs, end, passEntityNum, contentmask, time );
+}
+
 // BotLib traps start here
 int trap_BotLibSetup( void ) {
 	return syscall( BOTLIB_SETUP );
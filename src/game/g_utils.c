@@ -369,6 +369,87 @@ void G_InitGentity( gentity_t *e ) {
 	e->classname = "noclass";
 	e->s.number = e - g_entities;
 	e->r.ownerNum = ENTITYNUM_NONE;
+
+	// clients are run on their own
+	if ( e->s.number >= MAX_CLIENTS ) {
+		G_SetEntityList( e, ENTLIST_THINK );
+	}
+}
+
+/*
+=================
+G_SetEntityList
+
+Moves the entity from the active list it is in to another one
+=================
+*/
+void G_SetEntityList( gentity_t *e, entityList_t list ) {
+	if ( e->activeList == list ) {
+		return;
+	}
+
+	if ( e->activeList != ENTLIST_NONE ) {
+		if ( e->activePrev ) {
+			e->activePrev->activeNext = e->activeNext;
+		} else {
+			level.activeEntities[e->activeList] = e->activeNext;
+		}
+		if ( e->activeNext ) {
+			e->activeNext->activePrev = e->activePrev;
+		}
+	}
+
+	e->activeList = list;
+	e->activePrev = NULL;
+	e->activeNext = NULL;
+
+	if ( list != ENTLIST_NONE ) {
+		e->activeNext = level.activeEntities[list];
+		if ( e->activeNext ) {
+			e->activeNext->activePrev = e;
+		}
+		level.activeEntities[list] = e;
+	}
+}
+
+/*
+=================
+G_UpdateEntityList
+
+Entities change what they are after they are spawned, put this one in
+the list that matches how G_RunFrame will run it
+=================
+*/
+void G_UpdateEntityList( gentity_t *e ) {
+	entityList_t	list;
+
+	if ( e->freeAfterEvent ) {
+		list = ENTLIST_TEMP;
+	} else if ( e->s.eType == ET_MISSILE ) {
+		list = ENTLIST_MISSILE;
+	} else if ( e->s.eType == ET_ITEM || e->physicsObject ) {
+		list = ENTLIST_ITEM;
+	} else if ( e->s.eType == ET_MOVER ) {
+		list = ENTLIST_MOVER;
+	} else {
+		list = ENTLIST_THINK;
+	}
+
+	G_SetEntityList( e, list );
+}
+
+/*
+=================
+G_CanReuseEntity
+
+Slots aren't reused for a second, so the clients don't interpolate the
+old entity into the new one. The first couple seconds of server time can
+involve a lot of freeing and allocating, so the policy is relaxed for
+anything freed then.
+=================
+*/
+static qboolean G_CanReuseEntity( gentity_t *e ) {
+	return ( e->freetime <= level.startTime + 2000 || level.time - e->freetime >= 1000 ) ? qtrue : qfalse;
 }
 
 /*
@@ -387,35 +468,25 @@ angles and bad trails.
 =================
 */
 gentity_t *G_Spawn( void ) {
-	int			i, force;
+	int			i;
 	gentity_t	*e;
 
-	e = NULL;	// shut up warning
-	i = 0;		// shut up warning
-	for ( force = 0 ; force < 2 ; force++ ) {
-		// if we go through all entities and can't find one to free,
-		// override the normal minimum times before use
-		e = &g_entities[MAX_CLIENTS];
-		for ( i = MAX_CLIENTS ; i<level.num_entities ; i++, e++) {
-			if ( e->inuse ) {
-				continue;
-			}
-
-			// the first couple seconds of server time can involve a lot of
-			// freeing and allocating, so relax the replacement policy
-			if ( !force && e->freetime > level.startTime + 2000 && level.time - e->freetime < 1000 ) {
-				continue;
-			}
-
-			// reuse this slot
-			G_InitGentity( e );
-			return e;
-		}
-		if ( i != MAX_GENTITIES ) {
-			break;
+	// the free slots are queued in the order they were freed, so if
+	// the oldest can't be reused yet none of them can
+	e = level.freeEntities;
+	if ( e && ( G_CanReuseEntity( e ) || level.num_entities == ENTITYNUM_MAX_NORMAL ) ) {
+		// reuse this slot, overriding the minimum time if there are no new ones
+		level.freeEntities = e->freeNext;
+		if ( !level.freeEntities ) {
+			level.freeEntitiesTail = NULL;
 		}
+		e->freeNext = NULL;
+
+		G_InitGentity( e );
+		return e;
 	}
-	if ( i == ENTITYNUM_MAX_NORMAL ) {
+
+	if ( level.num_entities == ENTITYNUM_MAX_NORMAL ) {
 		for (i = 0; i < MAX_GENTITIES; i++) {
 			G_Printf("%4i: %s\n", i, g_entities[i].classname);
 		}
@@ -423,6 +494,7 @@ gentity_t *G_Spawn( void ) {
 	}
 	
 	// open up a new slot
+	e = &g_entities[level.num_entities];
 	level.num_entities++;
 
 	// let the server system know that there are more entities
@@ -439,18 +511,8 @@ G_EntitiesFree
 =================
 */
 qboolean G_EntitiesFree( void ) {
-	int			i;
-	gentity_t	*e;
-
-	e = &g_entities[MAX_CLIENTS];
-	for ( i = MAX_CLIENTS; i < level.num_entities; i++, e++) {
-		if ( e->inuse ) {
-			continue;
-		}
-		// slot available
-		return qtrue;
-	}
-	return qfalse;
+	// every free slot is in the queue
+	return level.freeEntities ? qtrue : qfalse;
 }
 
 
@@ -462,16 +524,40 @@ Marks the entity as free
 =================
 */
 void G_FreeEntity( gentity_t *ed ) {
+	qboolean	queued;
+	gentity_t	*freeNext;
+	int			freetime;
+
 	trap_UnlinkEntity (ed);		// unlink from world
 
 	if ( ed->neverFree ) {
 		return;
 	}
 
+	G_SetEntityList( ed, ENTLIST_NONE );
+
+	// a slot that is freed twice is already waiting in the queue, it
+	// keeps its free time so the queue stays sorted for G_Spawn
+	queued = ed->inuse ? qfalse : qtrue;
+	freeNext = ed->freeNext;
+	freetime = ed->freetime;
+
 	memset (ed, 0, sizeof(*ed));
 	ed->classname = "freed";
 	ed->freetime = level.time;
 	ed->inuse = qfalse;
+
+	if ( queued ) {
+		ed->freeNext = freeNext;
+		ed->freetime = freetime;
+	} else if ( ed - g_entities >= MAX_CLIENTS ) {
+		if ( level.freeEntitiesTail ) {
+			level.freeEntitiesTail->freeNext = ed;
+		} else {
+			level.freeEntities = ed;
+		}
+		level.freeEntitiesTail = ed;
+	}
 }
 
 /*
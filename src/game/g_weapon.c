@@ -31,6 +31,22 @@ static	vec3_t	muzzle;
 
 #define NUM_NAILSHOTS 15
 
+/*
+================
+G_HitscanTrace
+
+With g_antilag the other players are where the shooter saw them, at
+the time of the usercmd that fired, instead of where they are now
+================
+*/
+static void G_HitscanTrace( gentity_t *ent, trace_t *tr, const vec3_t start, const vec3_t end, int passent ) {
+	if ( g_antilag.integer && ent->client ) {
+		trap_TraceAtTime( tr, start, NULL, NULL, end, passent, MASK_SHOT, ent->client->pers.cmd.serverTime );
+	} else {
+		trap_Trace( tr, start, NULL, NULL, end, passent, MASK_SHOT );
+	}
+}
+
 /*
 ================
 G_BounceProjectile
@@ -169,7 +185,7 @@ void Bullet_Fire (gentity_t *ent, float spread, int damage ) {
 	passent = ent->s.number;
 	for (i = 0; i < 10; i++) {
 
-		trap_Trace (&tr, muzzle, NULL, NULL, end, passent, MASK_SHOT);
+		G_HitscanTrace( ent, &tr, muzzle, end, passent );
 		if ( tr.surfaceFlags & SURF_NOIMPACT ) {
 			return;
 		}
@@ -242,7 +258,7 @@ qboolean ShotgunPellet( vec3_t start, vec3_t end, gentity_t *ent ) {
 	VectorCopy( start, tr_start );
 	VectorCopy( end, tr_end );
 	for (i = 0; i < 10; i++) {
-		trap_Trace (&tr, tr_start, NULL, NULL, tr_end, passent, MASK_SHOT);
+		G_HitscanTrace( ent, &tr, tr_start, tr_end, passent );
 		traceEnt = &g_entities[ tr.entityNum ];
 
 		// send bullet impact
@@ -403,7 +419,7 @@ void weapon_railgun_fire (gentity_t *ent) {
 	hits = 0;
 	passent = ent->s.number;
 	do {
-		trap_Trace (&trace, muzzle, NULL, NULL, end, passent, MASK_SHOT );
+		G_HitscanTrace( ent, &trace, muzzle, end, passent );
 		if ( trace.entityNum >= ENTITYNUM_MAX_NORMAL ) {
 			break;
 		}
@@ -533,7 +549,7 @@ void Weapon_LightningFire( gentity_t *ent ) {
 	for (i = 0; i < 10; i++) {
 		VectorMA( muzzle, LIGHTNING_RANGE, forward, end );
 
-		trap_Trace( &tr, muzzle, NULL, NULL, end, passent, MASK_SHOT );
+		G_HitscanTrace( ent, &tr, muzzle, end, passent );
 
 		if ( tr.entityNum == ENTITYNUM_NONE ) {
 			return;